@@ -2,4 +2,5 @@
 
 option(BUILD_DEMO "Build the demo file" ON)
 option(BUILD_SHADERS "Build the shaders" ON)
-option(ENABLE_TESTS "Build tests" ON)
\ No newline at end of file
+option(ENABLE_TESTS "Build tests" ON)
+option(ENABLE_BENCHMARKS "Build and register the benchmarks with ctest" OFF)
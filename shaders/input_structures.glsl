@@ -8,12 +8,18 @@ layout(set = 0, binding = 0) uniform  SceneData{
     vec4 sunlightColor;
 } sceneData;
 
-layout(set = 1, binding = 0) uniform GLTFMaterialData{
-
+//bindless material table, indexed by the materialIndex push constant
+struct MaterialData {
     vec4 colorFactors;
     vec4 metal_rough_factors;
+    uint colorTexture;
+    uint metalRoughTexture;
+    uint pad0;
+    uint pad1;
+};
 
-} materialData;
+layout(set = 1, binding = 0) readonly buffer MaterialBuffer{
+    MaterialData materials[];
+};
 
-layout(set = 1, binding = 1) uniform sampler2D colorTex;
-layout(set = 1, binding = 2) uniform sampler2D metalRoughTex;
\ No newline at end of file
+layout(set = 1, binding = 1) uniform sampler2D textures[];
\ No newline at end of file
@@ -1,6 +1,7 @@
 #version 450
 
 #extension GL_GOOGLE_include_directive : require
+#extension GL_EXT_nonuniform_qualifier : require
 #include "input_structures.glsl"
 
 layout (location = 0) in vec3 inNormal;
@@ -9,11 +10,18 @@ layout (location = 2) in vec2 inUV;
 
 layout (location = 0) out vec4 outFragColor;
 
+//same block as mesh.vert, only the material index is read here
+layout( push_constant ) uniform constants
+{
+    layout(offset = 16) uint materialIndex;
+} PushConstants;
+
 void main()
 {
     float lightValue = max(dot(inNormal, sceneData.sunlightDirection.xyz), 0.1f);
 
-    vec3 color = inColor * texture(colorTex,inUV).xyz;
+    MaterialData material = materials[PushConstants.materialIndex];
+    vec3 color = inColor * texture(textures[material.colorTexture],inUV).xyz;
     vec3 ambient = color *  sceneData.ambientColor.xyz;
 
     outFragColor = vec4(color * lightValue *  sceneData.sunlightColor.w + ambient ,1.0f);
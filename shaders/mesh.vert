@@ -2,6 +2,7 @@
 
 #extension GL_GOOGLE_include_directive : require
 #extension GL_EXT_buffer_reference : require
+#extension GL_EXT_nonuniform_qualifier : require
 
 #include "input_structures.glsl"
 
@@ -22,23 +23,30 @@ layout(buffer_reference, std430) readonly buffer VertexBuffer{
     Vertex vertices[];
 };
 
+//rows of the affine world matrix, see GPUInstanceTransform
+layout(buffer_reference, std430) readonly buffer InstanceBuffer{
+    mat3x4 transforms[];
+};
+
 //push constants block
 layout( push_constant ) uniform constants
 {
-    mat4 render_matrix;
     VertexBuffer vertexBuffer;
+    InstanceBuffer instanceBuffer;
+    uint materialIndex;
 } PushConstants;
 
 void main()
 {
     Vertex v = PushConstants.vertexBuffer.vertices[gl_VertexIndex];
+    mat3x4 renderRows = PushConstants.instanceBuffer.transforms[gl_InstanceIndex];
 
     vec4 position = vec4(v.position, 1.0f);
 
-    gl_Position =  sceneData.viewproj * PushConstants.render_matrix *position;
+    gl_Position =  sceneData.viewproj * vec4(position * renderRows, 1.0f);
 
-    outNormal = (PushConstants.render_matrix * vec4(v.normal, 0.f)).xyz;
-    outColor = v.color.xyz * materialData.colorFactors.xyz;
+    outNormal = vec4(v.normal, 0.f) * renderRows;
+    outColor = v.color.xyz * materials[PushConstants.materialIndex].colorFactors.xyz;
     outUV.x = v.uv_x;
     outUV.y = v.uv_y;
-}
\ No newline at end of file
+}
@@ -0,0 +1,101 @@
+#include "core/JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+
+struct JobSystem::Loop {
+    const std::function<void(std::size_t, std::size_t, unsigned)>* fn;
+    std::size_t count;
+    std::size_t chunk;
+    std::atomic<std::size_t> next{0};
+};
+
+JobSystem::JobSystem(unsigned threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // slot 0 belongs to the thread calling parallel_for
+    _workers.reserve(threadCount - 1);
+    for (unsigned slot = 1; slot < threadCount; slot++) {
+        _workers.emplace_back([this, slot] { worker_main(slot); });
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_all();
+    for (std::thread& worker : _workers) {
+        worker.join();
+    }
+}
+
+void JobSystem::parallel_for(
+        std::size_t count, std::size_t grain,
+        const std::function<void(std::size_t, std::size_t, unsigned)>& fn) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<std::size_t>(grain, 1);
+    if (_workers.empty() || count <= grain) {
+        fn(0, count, 0);
+        return;
+    }
+
+    std::lock_guard submit(_submitMutex);
+
+    // a few chunks per thread balance uneven work without much contention
+    const std::size_t target = static_cast<std::size_t>(thread_count()) * 4;
+    Loop loop{.fn = &fn,
+              .count = count,
+              .chunk = std::max(grain, (count + target - 1) / target)};
+    {
+        std::lock_guard lock(_mutex);
+        _loop = &loop;
+        _busyWorkers = static_cast<unsigned>(_workers.size());
+        _generation++;
+    }
+    _wake.notify_all();
+
+    run_chunks(loop, 0);
+
+    std::unique_lock lock(_mutex);
+    _done.wait(lock, [this] { return _busyWorkers == 0; });
+    _loop = nullptr;
+}
+
+void JobSystem::worker_main(unsigned slot) {
+    uint64_t seen = 0;
+    while (true) {
+        Loop* loop;
+        {
+            std::unique_lock lock(_mutex);
+            _wake.wait(lock, [&] { return _stop || _generation != seen; });
+            if (_stop) {
+                return;
+            }
+            seen = _generation;
+            loop = _loop;
+        }
+
+        run_chunks(*loop, slot);
+
+        std::lock_guard lock(_mutex);
+        if (--_busyWorkers == 0) {
+            _done.notify_one();
+        }
+    }
+}
+
+void JobSystem::run_chunks(Loop& loop, unsigned slot) {
+    while (true) {
+        const std::size_t begin =
+                loop.next.fetch_add(loop.chunk, std::memory_order_relaxed);
+        if (begin >= loop.count) {
+            return;
+        }
+        (*loop.fn)(begin, std::min(begin + loop.chunk, loop.count), slot);
+    }
+}
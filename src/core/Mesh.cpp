@@ -13,15 +13,18 @@ Mesh::~Mesh() {
 void Mesh::set_model(const std::string &filePath) {
     VulkanEngine &engine = VulkanEngine::Get();
 
-    // Unregister current model if exists
-    if (!_currentModelPath.empty()) {
-        engine.unregisterMesh(_rid);
-    }
-
-    // Register new model
+    // Register the new model before dropping the old one, so that swapping
+    // to the same file reuses the cached asset instead of reloading it
+    const MeshHandle previous = _rid;
+    const bool hadModel = !_currentModelPath.empty();
     _currentModelPath = filePath;
     _rid = engine.registerMesh(filePath);
 
+    // the old buffers are freed once in-flight frames stop using them
+    if (hadModel) {
+        engine.unregisterMesh(previous);
+    }
+
     // Reapply transform to new model
     engine.setMeshTransform(_rid, _transform);
 }
@@ -5,6 +5,12 @@
 #include "core/Mesh.h"
 
 ModelImpl::~ModelImpl() {
+    // meshes unregister themselves from the engine, so they go first
+    _namedHandles.clear();
+    _meshes.clear();
+    for (const MeshHandle handle : _unnamedMeshes) {
+        _engine.unregisterMesh(handle);
+    }
     _engine.cleanup();
 }
 
@@ -28,9 +34,43 @@ void ModelImpl::createMesh(std::string name) {
 
     mesh->set_transform(glm::mat4(1.0f));
 
-    _meshes[name] = mesh;
+    // a mesh with the same name is replaced and unregisters itself
+    std::shared_ptr<Mesh> &slot = _meshes[name];
+    if (slot) {
+        _namedHandles.erase(slot->handle());
+    }
+    slot = mesh;
+    _namedHandles[mesh->handle()] = mesh.get();
 }
 
-void ModelImpl::setMeshTransform(std::string name, glm::mat4x4 transform) {
-    _meshes[name]->set_transform(transform);
+void ModelImpl::setMeshTransform(const std::string &name,
+                                 const glm::mat4x4 &transform) {
+    if (const auto it = _meshes.find(name); it != _meshes.end()) {
+        it->second->set_transform(transform);
+    }
+}
+
+void ModelImpl::createMeshes(std::span<MeshHandle> handles) {
+    _engine.registerMeshes("/basicmesh.glb", handles);
+    _unnamedMeshes.insert(_unnamedMeshes.end(), handles.begin(),
+                          handles.end());
+}
+
+IModel::MeshHandle ModelImpl::getMeshHandle(const std::string &name) const {
+    const auto it = _meshes.find(name);
+    return it != _meshes.end() ? it->second->handle() : kInvalidSlotHandle;
+}
+
+void ModelImpl::setMeshTransforms(std::span<const MeshHandle> handles,
+                                  std::span<const glm::mat4> transforms) {
+    _engine.setMeshTransforms(handles, transforms);
+    if (_namedHandles.empty()) {
+        return;
+    }
+    for (size_t i = 0; i < handles.size(); i++) {
+        if (const auto it = _namedHandles.find(handles[i]);
+            it != _namedHandles.end()) {
+            it->second->sync_transform(transforms[i]);
+        }
+    }
 }
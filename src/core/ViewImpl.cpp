@@ -83,6 +83,20 @@ void ViewImpl::run() const {
         if (ImGui::Begin("background")) {
             VulkanEngine &engine = VulkanEngine::Get();
             ImGui::SliderFloat("Render Scale", &engine.renderScale, 0.3f, 1.f);
+            ImGui::Checkbox("GPU driven", &engine.gpuDrivenRendering);
+            ImGui::Text("objects %u, culled %u, draw calls %u",
+                        engine.stats.objectCount,
+                        engine.stats.culledObjectCount, engine.stats.drawCount);
+            ImGui::Text("scene update %.3f ms", engine.stats.sceneUpdateTime);
+            ImGui::Text("pipeline binds %u, skipped %u",
+                        engine.stats.pipelineBinds,
+                        engine.stats.pipelineBindsSkipped);
+            ImGui::Text("descriptor set binds %u, skipped %u",
+                        engine.stats.descriptorSetBinds,
+                        engine.stats.descriptorSetBindsSkipped);
+            ImGui::Text("index buffer binds %u, skipped %u",
+                        engine.stats.indexBufferBinds,
+                        engine.stats.indexBufferBindsSkipped);
             // other code
         }
         ImGui::End();
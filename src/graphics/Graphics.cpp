@@ -7,51 +7,25 @@ Graphics* Graphics::getInstance() {
 }
 
 uint64_t Graphics::create_mesh_instance() {
-    std::uint64_t new_index;
-    std::uint64_t new_uid;
-
-    if (!meshes.empty()) {
-        auto lastPair = *meshes.rbegin();
+    return instances.insert(glm::dmat4(1.0));
+}
 
-        new_index = lastPair.second + 1;
-        new_uid = lastPair.first + 1;
-    } else {
-        new_index = 1;
-        new_uid = 0;
+void Graphics::set_mesh_instance_transform(uint64_t rid,
+                                           const glm::dmat4& matrix) {
+    if (glm::dmat4* transform = instances.get(rid)) {
+        *transform = matrix;
     }
-
-    meshes[new_uid] = new_index;
-
-    // VulkanRender::instances.push_back(glm::mat4(1.0));
-
-    return new_uid;
 }
 
-void Graphics::set_mesh_instance_transform([[maybe_unused]] uint64_t rid,
-                                           [[maybe_unused]] glm::mat4 matrix) {
-    // VulkanRender::instances[meshes[rid]] = matrix;
+void Graphics::set_mesh_instance_transforms(
+        std::span<const uint64_t> rids, std::span<const glm::dmat4> matrices) {
+    for (size_t i = 0; i < rids.size(); i++) {
+        set_mesh_instance_transform(rids[i], matrices[i]);
+    }
 }
 
 void Graphics::free_mesh_instance(uint64_t rid) {
-    // VulkanRender::instances.erase( VulkanRender::instances.begin() +
-    // meshes[rid] );
-
-    meshes.erase(rid);
-
-    auto it = meshes.find(rid);
-    if (it != meshes.end()) {
-        const size_t index = it->second;
-        // VulkanRender::instances.erase( VulkanRender::instances.begin() +
-        // index );
-
-        meshes.erase(it);
-
-        for (auto& entry : meshes) {
-            if (entry.second > index) {
-                entry.second--;
-            }
-        }
-    }
+    instances.erase(rid);
 }
 
-}  // namespace engine::graphics
\ No newline at end of file
+}  // namespace engine::graphics
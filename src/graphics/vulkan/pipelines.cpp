@@ -7,7 +7,6 @@ void GLTFMetallic_Roughness::build_pipelines(VulkanEngine* engine) {
     VkShaderModule meshVertexShader =
             load_shader(engine, "./shaders/mesh.vert.spv", "vertex");
 
-    create_material_layout(engine);
     VkPipelineLayout newLayout = create_pipeline_layout(engine);
 
     opaquePipeline.layout = newLayout;
@@ -32,26 +31,16 @@ VkShaderModule GLTFMetallic_Roughness::load_shader(VulkanEngine* engine,
     return shaderModule;
 }
 
-void GLTFMetallic_Roughness::create_material_layout(VulkanEngine* engine) {
-    DescriptorLayoutBuilder layoutBuilder;
-    layoutBuilder.add_binding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
-    layoutBuilder.add_binding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-    layoutBuilder.add_binding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-
-    materialLayout = layoutBuilder.build(
-            engine->_device,
-            VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
-}
-
 VkPipelineLayout GLTFMetallic_Roughness::create_pipeline_layout(
         VulkanEngine* engine) {
     VkPushConstantRange matrixRange{};
     matrixRange.offset = 0;
-    matrixRange.size = sizeof(GPUDrawPushConstants);
-    matrixRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    matrixRange.size = sizeof(GPUInstancedDrawPushConstants);
+    matrixRange.stageFlags =
+            VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 
     VkDescriptorSetLayout layouts[] = {engine->_gpuSceneDataDescriptorLayout,
-                                       materialLayout};
+                                       engine->bindless.layout()};
     VkPipelineLayoutCreateInfo mesh_layout_info =
             vkinit::pipeline_layout_create_info();
     mesh_layout_info.setLayoutCount = 2;
@@ -99,30 +88,17 @@ void GLTFMetallic_Roughness::build_transparent_pipeline(
 }
 
 MaterialInstance GLTFMetallic_Roughness::write_material(
-        VkDevice device, MaterialPass pass, const MaterialResources& resources,
-        DescriptorAllocatorGrowable& descriptorAllocator) {
+        MaterialPass pass, MaterialConstants constants,
+        const MaterialResources& resources, BindlessRegistry& registry) {
     MaterialInstance matData{};
     matData.passType = pass;
     matData.pipeline = (pass == MaterialPass::Transparent)
                                ? &transparentPipeline
                                : &opaquePipeline;
-    matData.materialSet = descriptorAllocator.allocate(device, materialLayout);
-
-    writer.clear();
-    writer.write_buffer(0, resources.dataBuffer, sizeof(MaterialConstants),
-                        resources.dataBufferOffset,
-                        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
-    writer.write_image(1, resources.colorImage.imageView,
-                       resources.colorSampler,
-                       VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                       VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-    writer.write_image(2, resources.metalRoughImage.imageView,
-                       resources.metalRoughSampler,
-                       VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                       VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-
-    writer.update_set(device, matData.materialSet);
-    writer.update_set(device, matData.materialSet);
+
+    constants.colorTexture = resources.colorTexture;
+    constants.metalRoughTexture = resources.metalRoughTexture;
+    matData.materialIndex = registry.add_material(constants);
 
     return matData;
 }
@@ -0,0 +1,56 @@
+#include "graphics/vulkan/vk_asset_cache.h"
+
+#include <filesystem>
+
+#include "core/Logging.h"
+#include "graphics/vulkan/vk_loader.h"
+
+std::string GLTFAssetCache::make_key(const std::string& filePath) {
+    return std::filesystem::path(filePath).lexically_normal().generic_string();
+}
+
+std::shared_ptr<LoadedGLTF> GLTFAssetCache::acquire(
+        VulkanEngine* engine, const std::string& filePath,
+        uint32_t references) {
+    const std::string key = make_key(filePath);
+
+    if (const auto it = _entries.find(key); it != _entries.end()) {
+        it->second.refCount += references;
+        return it->second.asset;
+    }
+
+    const auto loaded = loadGltf(engine, key);
+    if (!loaded.has_value()) {
+        LOGE("Failed to load asset {}", key);
+        return nullptr;
+    }
+
+    (*loaded)->sourcePath = key;
+    _entries.emplace(key, Entry{*loaded, references});
+    return *loaded;
+}
+
+void GLTFAssetCache::release(const std::string& filePath) {
+    const auto it = _entries.find(make_key(filePath));
+    if (it == _entries.end()) {
+        LOGW("Trying to release asset {}, but it is not cached", filePath);
+        return;
+    }
+
+    if (--it->second.refCount == 0) {
+        _entries.erase(it);
+    }
+}
+
+void GLTFAssetCache::clear() {
+    _entries.clear();
+}
+
+std::size_t GLTFAssetCache::size() const {
+    return _entries.size();
+}
+
+uint32_t GLTFAssetCache::ref_count(const std::string& filePath) const {
+    const auto it = _entries.find(make_key(filePath));
+    return it != _entries.end() ? it->second.refCount : 0;
+}
@@ -0,0 +1,188 @@
+#include "graphics/vulkan/vk_bindless.h"
+
+#include <array>
+
+#include "core/Logging.h"
+#include "graphics/vulkan/vk_engine.h"
+
+uint32_t BindlessRegistry::SlotAllocator::allocate() {
+    if (!free.empty()) {
+        const uint32_t slot = free.back();
+        free.pop_back();
+        return slot;
+    }
+    if (next < capacity) {
+        return next++;
+    }
+    return capacity;
+}
+
+void BindlessRegistry::SlotAllocator::retire(uint32_t slot, uint64_t frame) {
+    retired.emplace_back(frame, slot);
+}
+
+void BindlessRegistry::SlotAllocator::recycle(uint64_t frameNumber) {
+    // retired is in release order, so the reusable slots form a prefix
+    size_t count = 0;
+    while (count < retired.size() &&
+           retired[count].first + FRAME_OVERLAP <= frameNumber) {
+        free.push_back(retired[count].second);
+        count++;
+    }
+    retired.erase(retired.begin(), retired.begin() + count);
+}
+
+void BindlessRegistry::init(VulkanEngine* engine) {
+    _engine = engine;
+    _materialSlots = SlotAllocator{.capacity = kMaxMaterials};
+    _textureSlots = SlotAllocator{.capacity = kMaxTextures};
+    _textures.assign(kMaxTextures, TextureSlot{});
+    _textureLookup.clear();
+
+    const std::array<VkDescriptorBindingFlags, 2> bindingFlags = {
+            VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                    VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT,
+            VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                    VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT |
+                    VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT};
+    const VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+            .bindingCount = static_cast<uint32_t>(bindingFlags.size()),
+            .pBindingFlags = bindingFlags.data()};
+
+    DescriptorLayoutBuilder builder;
+    builder.add_binding(kMaterialBinding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+    builder.add_binding(kTextureBinding,
+                        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                        kMaxTextures);
+    _layout = builder.build(
+            engine->_device,
+            VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+            &bindingFlagsInfo,
+            VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT);
+
+    const std::array<VkDescriptorPoolSize, 2> poolSizes = {
+            VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1},
+            VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                 kMaxTextures}};
+    VkDescriptorPoolCreateInfo poolInfo = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    VK_CHECK(vkCreateDescriptorPool(engine->_device, &poolInfo, nullptr,
+                                    &_pool));
+
+    VkDescriptorSetAllocateInfo allocInfo = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+    allocInfo.descriptorPool = _pool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &_layout;
+    VK_CHECK(vkAllocateDescriptorSets(engine->_device, &allocInfo, &_set));
+
+    const AllocatedBuffer materials = engine->create_buffer(
+            sizeof(GLTFMetallic_Roughness::MaterialConstants) * kMaxMaterials,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+    _materials = std::make_unique<VulkanBuffer>(engine->_allocator, materials);
+    _materialData = static_cast<GLTFMetallic_Roughness::MaterialConstants*>(
+            materials.info.pMappedData);
+
+    // the material buffer never moves, only its contents change
+    DescriptorWriter writer;
+    writer.write_buffer(kMaterialBinding, materials.buffer, VK_WHOLE_SIZE, 0,
+                        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+    writer.update_set(engine->_device, _set);
+}
+
+void BindlessRegistry::destroy() {
+    if (!_engine) {
+        return;
+    }
+
+    _materials.reset();
+    _materialData = nullptr;
+    vkDestroyDescriptorPool(_engine->_device, _pool, nullptr);
+    vkDestroyDescriptorSetLayout(_engine->_device, _layout, nullptr);
+    _pool = VK_NULL_HANDLE;
+    _layout = VK_NULL_HANDLE;
+    _set = VK_NULL_HANDLE;
+    _engine = nullptr;
+}
+
+void BindlessRegistry::begin_frame(uint64_t frameNumber) {
+    _frameNumber = frameNumber;
+    _materialSlots.recycle(frameNumber);
+    _textureSlots.recycle(frameNumber);
+}
+
+uint32_t BindlessRegistry::acquire_texture(VkImageView view,
+                                           VkSampler sampler) {
+    const auto key = std::make_pair(view, sampler);
+    if (const auto it = _textureLookup.find(key); it != _textureLookup.end()) {
+        _textures[it->second].refCount++;
+        return it->second;
+    }
+
+    const uint32_t slot = _textureSlots.allocate();
+    if (slot == kMaxTextures) {
+        LOGE("Bindless texture array is full ({} textures)", kMaxTextures);
+        return kFallbackSlot;
+    }
+
+    _textures[slot] = TextureSlot{view, sampler, 1};
+    _textureLookup.emplace(key, slot);
+
+    const VkDescriptorImageInfo imageInfo{
+            .sampler = sampler,
+            .imageView = view,
+            .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    VkWriteDescriptorSet write = {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+    write.dstSet = _set;
+    write.dstBinding = kTextureBinding;
+    write.dstArrayElement = slot;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo = &imageInfo;
+    vkUpdateDescriptorSets(_engine->_device, 1, &write, 0, nullptr);
+
+    return slot;
+}
+
+void BindlessRegistry::release_texture(uint32_t index) {
+    if (index == kFallbackSlot || index >= kMaxTextures ||
+        _textures[index].refCount == 0) {
+        return;
+    }
+
+    TextureSlot& texture = _textures[index];
+    if (--texture.refCount > 0) {
+        return;
+    }
+
+    _textureLookup.erase(std::make_pair(texture.view, texture.sampler));
+    texture = TextureSlot{};
+    _textureSlots.retire(index, _frameNumber);
+}
+
+uint32_t BindlessRegistry::add_material(
+        const GLTFMetallic_Roughness::MaterialConstants& constants) {
+    const uint32_t slot = _materialSlots.allocate();
+    if (slot == kMaxMaterials) {
+        LOGE("Bindless material buffer is full ({} materials)", kMaxMaterials);
+        return kFallbackSlot;
+    }
+
+    // the slot is not referenced by any frame in flight, so writing through
+    // the mapping is safe
+    _materialData[slot] = constants;
+    return slot;
+}
+
+void BindlessRegistry::remove_material(uint32_t index) {
+    if (index == kFallbackSlot || index >= kMaxMaterials) {
+        return;
+    }
+    _materialSlots.retire(index, _frameNumber);
+}
@@ -0,0 +1,155 @@
+#include "graphics/vulkan/vk_culling.h"
+
+#include <algorithm>
+#include <glm/geometric.hpp>
+
+#include "graphics/vulkan/vk_engine.h"
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+Frustum Frustum::from_matrix(const glm::mat4& viewproj) {
+    // glm is column major, rows of the matrix are gathered across columns
+    const auto row = [&](int i) {
+        return glm::vec4(viewproj[0][i], viewproj[1][i], viewproj[2][i],
+                         viewproj[3][i]);
+    };
+
+    // Gribb-Hartmann extraction. The near plane uses the -w..w depth range,
+    // which is conservative for a 0..w projection as well.
+    Frustum frustum;
+    frustum.planes[0] = row(3) + row(0);  // left
+    frustum.planes[1] = row(3) - row(0);  // right
+    frustum.planes[2] = row(3) + row(1);  // bottom
+    frustum.planes[3] = row(3) - row(1);  // top
+    frustum.planes[4] = row(3) + row(2);  // near
+    frustum.planes[5] = row(3) - row(2);  // far
+
+    for (glm::vec4& plane : frustum.planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+
+    return frustum;
+}
+
+std::size_t FrustumCuller::cull(const Frustum& frustum,
+                                const std::vector<RenderObject>& objects,
+                                std::size_t begin, std::size_t end,
+                                std::vector<uint32_t>& visible) {
+    const std::size_t count = end - begin;
+
+    load_spheres(objects, begin, end);
+    test_spheres(frustum, count);
+
+    std::size_t culled = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        if (objects[begin + i].material == nullptr) {
+            continue;
+        }
+        if (_visible[i]) {
+            visible.push_back(static_cast<uint32_t>(begin + i));
+        } else {
+            culled++;
+        }
+    }
+
+    return culled;
+}
+
+void FrustumCuller::load_spheres(const std::vector<RenderObject>& objects,
+                                 std::size_t begin, std::size_t end) {
+    const std::size_t count = end - begin;
+
+    _centerX.resize(count);
+    _centerY.resize(count);
+    _centerZ.resize(count);
+    _radius.resize(count);
+    _visible.resize(count);
+
+    for (std::size_t i = 0; i < count; i++) {
+        const glm::mat4& m = objects[begin + i].transform;
+        const Bounds& bounds = objects[begin + i].bounds;
+
+        const glm::vec4 center = m * glm::vec4(bounds.origin, 1.f);
+        // the largest axis scale keeps the sphere conservative
+        const float scale = std::max({glm::length(glm::vec3(m[0])),
+                                      glm::length(glm::vec3(m[1])),
+                                      glm::length(glm::vec3(m[2]))});
+
+        _centerX[i] = center.x;
+        _centerY[i] = center.y;
+        _centerZ[i] = center.z;
+        _radius[i] = bounds.sphereRadius * scale;
+    }
+}
+
+void FrustumCuller::test_spheres(const Frustum& frustum, std::size_t count) {
+    const float* x = _centerX.data();
+    const float* y = _centerY.data();
+    const float* z = _centerZ.data();
+    const float* r = _radius.data();
+    uint8_t* visible = _visible.data();
+
+    std::size_t i = 0;
+
+#if defined(__AVX__)
+    for (; i + 8 <= count; i += 8) {
+        const __m256 px = _mm256_loadu_ps(x + i);
+        const __m256 py = _mm256_loadu_ps(y + i);
+        const __m256 pz = _mm256_loadu_ps(z + i);
+        const __m256 negR = _mm256_sub_ps(_mm256_setzero_ps(),
+                                          _mm256_loadu_ps(r + i));
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (const glm::vec4& plane : frustum.planes) {
+            __m256 dist = _mm256_mul_ps(_mm256_set1_ps(plane.x), px);
+            dist = _mm256_add_ps(dist,
+                                 _mm256_mul_ps(_mm256_set1_ps(plane.y), py));
+            dist = _mm256_add_ps(dist,
+                                 _mm256_mul_ps(_mm256_set1_ps(plane.z), pz));
+            dist = _mm256_add_ps(dist, _mm256_set1_ps(plane.w));
+            inside = _mm256_and_ps(inside,
+                                   _mm256_cmp_ps(dist, negR, _CMP_GE_OQ));
+        }
+
+        const int mask = _mm256_movemask_ps(inside);
+        for (int lane = 0; lane < 8; lane++) {
+            visible[i + lane] = static_cast<uint8_t>((mask >> lane) & 1);
+        }
+    }
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+    for (; i + 4 <= count; i += 4) {
+        const __m128 px = _mm_loadu_ps(x + i);
+        const __m128 py = _mm_loadu_ps(y + i);
+        const __m128 pz = _mm_loadu_ps(z + i);
+        const __m128 negR = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(r + i));
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const glm::vec4& plane : frustum.planes) {
+            __m128 dist = _mm_mul_ps(_mm_set1_ps(plane.x), px);
+            dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(plane.y), py));
+            dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(plane.z), pz));
+            dist = _mm_add_ps(dist, _mm_set1_ps(plane.w));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, negR));
+        }
+
+        const int mask = _mm_movemask_ps(inside);
+        for (int lane = 0; lane < 4; lane++) {
+            visible[i + lane] = static_cast<uint8_t>((mask >> lane) & 1);
+        }
+    }
+#endif
+
+    for (; i < count; i++) {
+        bool inside = true;
+        for (const glm::vec4& plane : frustum.planes) {
+            const float dist =
+                    plane.x * x[i] + plane.y * y[i] + plane.z * z[i] + plane.w;
+            inside = inside && dist >= -r[i];
+        }
+        visible[i] = inside ? 1 : 0;
+    }
+}
@@ -0,0 +1,65 @@
+#include "graphics/vulkan/vk_deletion_queue.h"
+
+#include <algorithm>
+
+DeferredDeletionQueue::Bucket& DeferredDeletionQueue::bucket(uint64_t frame) {
+    // releases almost always carry the current frame, which is the back
+    if (_buckets.empty() || _buckets.back().frame < frame) {
+        _buckets.push_back(Bucket{.frame = frame});
+        return _buckets.back();
+    }
+
+    const auto it = std::lower_bound(
+            _buckets.begin(), _buckets.end(), frame,
+            [](const Bucket& b, uint64_t value) { return b.frame < value; });
+    if (it != _buckets.end() && it->frame == frame) {
+        return *it;
+    }
+    return *_buckets.insert(it, Bucket{.frame = frame});
+}
+
+void DeferredDeletionQueue::push(uint64_t lastUsedFrame,
+                                 std::unique_ptr<VulkanBuffer> buffer) {
+    bucket(lastUsedFrame).buffers.push_back(std::move(buffer));
+}
+
+void DeferredDeletionQueue::push(uint64_t lastUsedFrame,
+                                 std::unique_ptr<VulkanImage> image) {
+    bucket(lastUsedFrame).images.push_back(std::move(image));
+}
+
+void DeferredDeletionQueue::push(uint64_t lastUsedFrame, VkSampler sampler) {
+    bucket(lastUsedFrame).samplers.push_back(sampler);
+}
+
+void DeferredDeletionQueue::push(uint64_t lastUsedFrame,
+                                 VkDescriptorPool pool) {
+    bucket(lastUsedFrame).descriptorPools.push_back(pool);
+}
+
+void DeferredDeletionQueue::collect(VkDevice device, uint64_t completedFrame) {
+    while (!_buckets.empty() && _buckets.front().frame <= completedFrame) {
+        destroy(device, _buckets.front());
+        _buckets.pop_front();
+    }
+}
+
+void DeferredDeletionQueue::flush(VkDevice device) {
+    for (Bucket& b : _buckets) {
+        destroy(device, b);
+    }
+    _buckets.clear();
+}
+
+void DeferredDeletionQueue::destroy(VkDevice device, Bucket& bucket) {
+    bucket.buffers.clear();
+    bucket.images.clear();
+    for (const VkSampler sampler : bucket.samplers) {
+        vkDestroySampler(device, sampler, nullptr);
+    }
+    for (const VkDescriptorPool pool : bucket.descriptorPools) {
+        vkDestroyDescriptorPool(device, pool, nullptr);
+    }
+    bucket.samplers.clear();
+    bucket.descriptorPools.clear();
+}
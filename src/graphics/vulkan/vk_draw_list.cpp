@@ -0,0 +1,72 @@
+#include "graphics/vulkan/vk_draw_list.h"
+
+#include <algorithm>
+
+#include "core/JobSystem.h"
+#include "graphics/vulkan/vk_draw_sort.h"
+#include "graphics/vulkan/vk_engine.h"
+
+std::size_t DrawListBuilder::build(JobSystem* jobs, const glm::mat4& viewproj,
+                                   const glm::mat4& view, float farPlane,
+                                   std::vector<RenderObject>& objects,
+                                   std::vector<uint32_t>& visible) {
+    const std::size_t count = objects.size();
+    const std::size_t chunkCount = (count + kChunkSize - 1) / kChunkSize;
+    const unsigned threadCount = jobs ? jobs->thread_count() : 1;
+
+    // shrinking would drop the capacity the lists grew last frames
+    if (_chunks.size() < chunkCount) {
+        _chunks.resize(chunkCount);
+    }
+    if (_cullers.size() < threadCount) {
+        _cullers.resize(threadCount);
+    }
+
+    const Frustum frustum = Frustum::from_matrix(viewproj);
+    const auto cullChunks = [&](std::size_t begin, std::size_t end,
+                                unsigned slot) {
+        FrustumCuller& culler = _cullers[slot];
+        for (std::size_t c = begin; c < end; c++) {
+            Chunk& chunk = _chunks[c];
+            chunk.visible.clear();
+            chunk.culled = culler.cull(frustum, objects, c * kChunkSize,
+                                       std::min(count, (c + 1) * kChunkSize),
+                                       chunk.visible);
+            for (const uint32_t index : chunk.visible) {
+                assign_sort_key(view, farPlane, objects[index]);
+            }
+        }
+    };
+
+    std::size_t culled = 0;
+    std::size_t visibleCount = 0;
+    const auto merge = [&] {
+        for (std::size_t c = 0; c < chunkCount; c++) {
+            _chunks[c].offset = visibleCount;
+            visibleCount += _chunks[c].visible.size();
+            culled += _chunks[c].culled;
+        }
+        visible.resize(visibleCount);
+    };
+    const auto copyChunks = [&](std::size_t begin, std::size_t end,
+                                unsigned) {
+        for (std::size_t c = begin; c < end; c++) {
+            std::ranges::copy(_chunks[c].visible,
+                              visible.begin() +
+                                      static_cast<std::ptrdiff_t>(
+                                              _chunks[c].offset));
+        }
+    };
+
+    if (jobs) {
+        jobs->parallel_for(chunkCount, 1, cullChunks);
+        merge();
+        jobs->parallel_for(chunkCount, 1, copyChunks);
+    } else {
+        cullChunks(0, chunkCount, 0);
+        merge();
+        copyChunks(0, chunkCount, 0);
+    }
+
+    return culled;
+}
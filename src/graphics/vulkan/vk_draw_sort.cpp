@@ -0,0 +1,120 @@
+#include "graphics/vulkan/vk_draw_sort.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+#include "graphics/vulkan/vk_engine.h"
+
+namespace {
+constexpr int kPassBits = 2;
+constexpr int kPipelineBits = 10;
+constexpr int kMaterialBits = 16;
+constexpr int kMeshBits = 16;
+constexpr int kDepthBits = 20;
+
+static_assert(kPassBits + kPipelineBits + kMaterialBits + kMeshBits +
+                      kDepthBits ==
+              64);
+
+// vulkan handles are pointers on 64 bit targets and integers elsewhere
+template <typename Handle>
+uint64_t handle_bits(Handle handle) {
+    if constexpr (std::is_pointer_v<Handle>) {
+        return reinterpret_cast<uintptr_t>(handle);
+    } else {
+        return static_cast<uint64_t>(handle);
+    }
+}
+
+template <typename Handle>
+uint64_t hash_handle(Handle handle, int bits) {
+    // fibonacci hashing, the top bits are the well mixed ones
+    return (handle_bits(handle) * 0x9E3779B97F4A7C15ull) >> (64 - bits);
+}
+}  // namespace
+
+uint64_t make_sort_key(const RenderObject& object, float viewDepth,
+                       float farPlane) {
+    const MaterialInstance& material = *object.material;
+
+    constexpr uint64_t maxDepth = (1ull << kDepthBits) - 1;
+    const float depth = std::clamp(viewDepth / farPlane, 0.f, 1.f);
+
+    uint64_t key = static_cast<uint64_t>(material.passType) &
+                   ((1ull << kPassBits) - 1);
+    key = (key << kPipelineBits) |
+          hash_handle(material.pipeline->pipeline, kPipelineBits);
+    key = (key << kMaterialBits) |
+          (material.materialIndex & ((1ull << kMaterialBits) - 1));
+    key = (key << kMeshBits) |
+          hash_handle(handle_bits(object.indexBuffer) + object.firstIndex,
+                      kMeshBits);
+    key = (key << kDepthBits) |
+          static_cast<uint64_t>(depth * static_cast<float>(maxDepth));
+
+    return key;
+}
+
+uint64_t assign_sort_key(const glm::mat4& view, float farPlane,
+                         RenderObject& object) {
+    const glm::vec4 center =
+            view * (object.transform * glm::vec4(object.bounds.origin, 1.f));
+
+    // the camera looks down -z in view space
+    object.sortKey = make_sort_key(object, -center.z, farPlane);
+    return object.sortKey;
+}
+
+bool can_instance(const RenderObject& a, const RenderObject& b) {
+    return a.indexBuffer == b.indexBuffer && a.firstIndex == b.firstIndex &&
+           a.indexCount == b.indexCount &&
+           a.vertexBufferAddress == b.vertexBufferAddress &&
+           a.material == b.material;
+}
+
+void DrawSorter::sort_assigned(const std::vector<RenderObject>& objects,
+                               const std::vector<uint32_t>& subset,
+                               std::vector<uint32_t>& order) {
+    _entries.resize(subset.size());
+    for (std::size_t i = 0; i < subset.size(); i++) {
+        _entries[i] = {objects[subset[i]].sortKey, subset[i]};
+    }
+
+    radix_sort(order);
+}
+
+void DrawSorter::radix_sort(std::vector<uint32_t>& order) {
+    const std::size_t count = _entries.size();
+    _scratch.resize(count);
+
+    for (int shift = 0; shift < 64; shift += 8) {
+        std::array<uint32_t, 256> histogram{};
+        for (const Entry& entry : _entries) {
+            histogram[(entry.key >> shift) & 0xFF]++;
+        }
+
+        // every key has the same byte here, the pass would not move anything
+        if (std::ranges::find(histogram, count) != histogram.end()) {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for (uint32_t& bucket : histogram) {
+            const uint32_t size = bucket;
+            bucket = offset;
+            offset += size;
+        }
+
+        for (const Entry& entry : _entries) {
+            _scratch[histogram[(entry.key >> shift) & 0xFF]++] = entry;
+        }
+        _entries.swap(_scratch);
+    }
+
+    order.resize(count);
+    for (std::size_t i = 0; i < count; i++) {
+        order[i] = _entries[i].index;
+    }
+}
@@ -6,12 +6,12 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <chrono>
 #include <cmath>
 #include <cstring>
 #include <filesystem>
 #include <fmt/base.h>
 #include <optional>
-#include <random>
 #include <system_error>
 
 #include "core/Logging.h"
@@ -28,6 +28,7 @@
 #include <vk_mem_alloc.h>
 
 #define GLM_ENABLE_EXPERIMENTAL
+#include <glm/geometric.hpp>
 #include <glm/gtx/transform.hpp>
 
 #include "graphics/vulkan/vk_images.h"
@@ -160,34 +161,20 @@ void VulkanEngine::init_default_data() {
     sampl.minFilter = VK_FILTER_LINEAR;
     vkCreateSampler(_device, &sampl, nullptr, &_defaultSamplerLinear);
 
+    // the first texture and material take the registry's fallback slots and
+    // live as long as the engine
     GLTFMetallic_Roughness::MaterialResources materialResources{};
-    // default the material textures
-    materialResources.colorImage = _whiteImage->get();
-    materialResources.colorSampler = _defaultSamplerLinear;
-    materialResources.metalRoughImage = _whiteImage->get();
-    materialResources.metalRoughSampler = _defaultSamplerLinear;
-
-    // set the uniform buffer for the material data
-    const AllocatedBuffer materialConstants = create_buffer(
-            sizeof(GLTFMetallic_Roughness::MaterialConstants),
-            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
-
-    // write the buffer
-    auto* sceneUniformData =
-            (GLTFMetallic_Roughness::MaterialConstants*)
-                    materialConstants.allocation->GetMappedData();
-    sceneUniformData->colorFactors = glm::vec4{1, 1, 1, 1};
-    sceneUniformData->metal_rough_factors = glm::vec4{1, 0.5, 0, 0};
-
-    // Store material constants buffer in managed buffers for automatic cleanup
-    _managedBuffers.push_back(std::make_unique<VulkanBuffer>(_allocator, materialConstants));
-
-    materialResources.dataBuffer = materialConstants.buffer;
-    materialResources.dataBufferOffset = 0;
+    materialResources.colorTexture = bindless.acquire_texture(
+            _whiteImage->imageView(), _defaultSamplerLinear);
+    materialResources.metalRoughTexture = materialResources.colorTexture;
+
+    GLTFMetallic_Roughness::MaterialConstants materialConstants{};
+    materialConstants.colorFactors = glm::vec4{1, 1, 1, 1};
+    materialConstants.metal_rough_factors = glm::vec4{1, 0.5, 0, 0};
 
     defaultData = metalRoughMaterial.write_material(
-            _device, MaterialPass::MainColor, materialResources,
-            globalDescriptorAllocator);
+            MaterialPass::MainColor, materialConstants, materialResources,
+            bindless);
 }
 
 void VulkanEngine::init_imgui() {
@@ -258,7 +245,8 @@ void VulkanEngine::init_descriptors() {
     // create a descriptor pool that will hold 10 sets with 1 image each
     std::vector<DescriptorAllocatorGrowable::PoolSizeRatio> sizes = {
             {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1},
-            {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1}};
+            {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1},
+            {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1}};
 
     globalDescriptorAllocator.init(_device, 10, sizes);
 
@@ -272,7 +260,7 @@ void VulkanEngine::init_descriptors() {
 
     {
         DescriptorLayoutBuilder builder;
-        builder.add_binding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+        builder.add_binding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC);
         _gpuSceneDataDescriptorLayout =
                 builder.build(_device, VK_SHADER_STAGE_VERTEX_BIT |
                                                VK_SHADER_STAGE_FRAGMENT_BIT);
@@ -296,7 +284,22 @@ void VulkanEngine::init_descriptors() {
 
     writer.update_set(_device, _drawImageDescriptors);
 
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(_chosenGPU, &properties);
+    const VkDeviceSize arenaAlignment =
+            std::max({properties.limits.minUniformBufferOffsetAlignment,
+                      properties.limits.minStorageBufferOffsetAlignment,
+                      VkDeviceSize{16}});
+
     for (auto& _frame : command_buffers_container._frames) {
+        _frame._arena.init(_allocator, _device, FRAME_ARENA_SIZE,
+                           arenaAlignment);
+
+        // the scene data always lives in the arena, only the offset changes
+        _frame._sceneDescriptor = globalDescriptorAllocator.allocate(
+                _device, _gpuSceneDataDescriptorLayout);
+        write_scene_descriptor(_frame);
+
         // create a descriptor pool
         std::vector<DescriptorAllocatorGrowable::PoolSizeRatio> frame_sizes = {
                 {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 3},
@@ -310,12 +313,15 @@ void VulkanEngine::init_descriptors() {
 
         // No need for deletion queue - frame descriptors will be cleaned up in cleanup()
     }
+
+    bindless.init(this);
 }
 
 void VulkanEngine::init_pipelines() {
     pipelines.init(_device, _singleImageDescriptorLayout, _drawImageDescriptorLayout, _drawImage->get());
     // Pipeline cleanup is handled automatically by the Pipelines object
     metalRoughMaterial.build_pipelines(this);
+    gpuDrivenRenderer.init(this);
 }
 
 void VulkanEngine::init(SDL_Window* window) {
@@ -328,6 +334,7 @@ void VulkanEngine::init(SDL_Window* window) {
     init_swapchain();
     
     command_buffers.init_commands(this);
+    uploads.init(this, _transferQueue, _transferQueueFamily);
     
     command_buffers_container.init_sync_structures(this);
     init_descriptors();
@@ -343,10 +350,10 @@ void VulkanEngine::init(SDL_Window* window) {
 
     const std::string structurePath = {std::string(ASSETS_DIR) +
                                        "/basicmesh.glb"};
-    const auto structureFile = loadGltf(this, structurePath);
+    const auto structureFile = assetCache.acquire(this, structurePath);
 
-    assert(structureFile.has_value());
-    loadedScenes["structure"] = *structureFile;
+    assert(structureFile != nullptr);
+    loadedScenes["structure"] = structureFile;
 
     _isInitialized = true;
 }
@@ -406,6 +413,13 @@ void VulkanEngine::init_vulkan() {
     VkPhysicalDeviceVulkan12Features features12{};
     features12.bufferDeviceAddress = true;
     features12.descriptorIndexing = true;
+    features12.drawIndirectCount = true;
+    features12.timelineSemaphore = true;
+    features12.runtimeDescriptorArray = true;
+    features12.descriptorBindingPartiallyBound = true;
+    features12.descriptorBindingSampledImageUpdateAfterBind = true;
+    features12.descriptorBindingStorageBufferUpdateAfterBind = true;
+    features12.descriptorBindingUpdateUnusedWhilePending = true;
 
     // use vkbootstrap to select a gpu.
     // We want a gpu that can write to the SDL surface and supports vulkan 1.3
@@ -455,6 +469,20 @@ void VulkanEngine::init_vulkan() {
 
     _graphicsQueueFamily = queue_family_ret.value();
 
+    // uploads prefer a transfer only family so copies overlap rendering
+    auto transfer_queue_ret =
+            vkbDevice.get_dedicated_queue(vkb::QueueType::transfer);
+    auto transfer_family_ret =
+            vkbDevice.get_dedicated_queue_index(vkb::QueueType::transfer);
+    if (transfer_queue_ret && transfer_family_ret) {
+        _transferQueue = transfer_queue_ret.value();
+        _transferQueueFamily = transfer_family_ret.value();
+    } else {
+        LOGW("No dedicated transfer queue, uploading on the graphics queue");
+        _transferQueue = _graphicsQueue;
+        _transferQueueFamily = _graphicsQueueFamily;
+    }
+
     // initialize the memory allocator
     VmaAllocatorCreateInfo allocatorInfo = {};
     allocatorInfo.physicalDevice = _chosenGPU;
@@ -594,7 +622,19 @@ void VulkanEngine::cleanup() {
         // make sure the gpu has stopped doing its things
         vkDeviceWaitIdle(_device);
 
+        meshes.clear();
+        mainDrawContext = {};
+        _deadRenderProxies = 0;
         loadedScenes.clear();
+        assetCache.clear();
+        for (const auto& mesh : testMeshes) {
+            defer_destroy(mesh->meshBuffers);
+        }
+        testMeshes.clear();
+        gpuDrivenRenderer.destroy();
+        bindless.destroy();
+        uploads.destroy();
+        deletionQueue.flush(_device);
 
         // Smart pointers will automatically clean up resources
 
@@ -605,8 +645,14 @@ void VulkanEngine::cleanup() {
                 vkDestroyCommandPool(_device, _frame._commandPool->get(), nullptr);
             }
 
+            _frame._secondaryPools.clear();
+
             // Destroy frame descriptors manually
             _frame._frameDescriptors.destroy_pools(_device);
+
+            // buffers have to go before the allocator
+            _frame._frameBuffers.clear();
+            _frame._arena.destroy();
         }
 
         destroy_swapchain();
@@ -649,10 +695,82 @@ AllocatedBuffer VulkanEngine::create_buffer(size_t allocSize,
     return newBuffer;
 }
 
+void VulkanEngine::write_scene_descriptor(FrameData& frame) const {
+    DescriptorWriter sceneWriter;
+    sceneWriter.write_buffer(0, frame._arena.buffer(), sizeof(GPUSceneData), 0,
+                             VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC);
+    sceneWriter.update_set(_device, frame._sceneDescriptor);
+}
+
+void VulkanEngine::grow_frame_arena(FrameData& frame) {
+    const VkDeviceSize required = frame._arena.used() + frame._arena.overflow();
+    VkDeviceSize capacity = frame._arena.capacity() * 2;
+    while (capacity < required) {
+        capacity *= 2;
+    }
+    LOGW("Frame arena needed {} bytes, growing it to {} bytes", required,
+         capacity);
+
+    deletionQueue.push(_frameNumber,
+                       frame._arena.grow(_allocator, _device, capacity));
+    // this frame slot's fence has signaled, nothing reads its set anymore
+    write_scene_descriptor(frame);
+}
+
+FrameArena::Allocation VulkanEngine::allocate_frame_data(VkDeviceSize size) {
+    FrameData& frame = get_current_frame();
+    if (const auto allocation = frame._arena.allocate(size)) {
+        return *allocation;
+    }
+
+    // the arena is full, fall back to a dedicated buffer for this frame, the
+    // arena grows the next time this frame slot comes around
+
+    const AllocatedBuffer buffer =
+            create_buffer(size,
+                          VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+                                  VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                  VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                          VMA_MEMORY_USAGE_CPU_TO_GPU);
+    frame._frameBuffers.push_back(
+            std::make_unique<VulkanBuffer>(_allocator, buffer));
+
+    const VkBufferDeviceAddressInfo deviceAddressInfo{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+            .buffer = buffer.buffer};
+    return {buffer.buffer, 0, buffer.info.pMappedData,
+            vkGetBufferDeviceAddress(_device, &deviceAddressInfo)};
+}
+
 void VulkanEngine::destroy_buffer(const AllocatedBuffer& buffer) const {
     vmaDestroyBuffer(_allocator, buffer.buffer, buffer.allocation);
 }
 
+void VulkanEngine::defer_destroy(const AllocatedBuffer& buffer) {
+    if (buffer.buffer != VK_NULL_HANDLE) {
+        deletionQueue.push(_frameNumber,
+                           std::make_unique<VulkanBuffer>(_allocator, buffer));
+    }
+}
+
+void VulkanEngine::defer_destroy(const AllocatedImage& image) {
+    if (image.image != VK_NULL_HANDLE) {
+        deletionQueue.push(_frameNumber, std::make_unique<VulkanImage>(
+                                                 _allocator, _device, image));
+    }
+}
+
+void VulkanEngine::defer_destroy(VkSampler sampler) {
+    if (sampler != VK_NULL_HANDLE) {
+        deletionQueue.push(_frameNumber, sampler);
+    }
+}
+
+void VulkanEngine::defer_destroy(const GPUMeshBuffers& meshBuffers) {
+    defer_destroy(meshBuffers.vertexBuffer);
+    defer_destroy(meshBuffers.indexBuffer);
+}
+
 GPUMeshBuffers VulkanEngine::uploadMesh(std::span<uint32_t> indices,
                                         std::span<Vertex> vertices) {
     const size_t vertexBufferSize = vertices.size() * sizeof(Vertex);
@@ -681,41 +799,14 @@ GPUMeshBuffers VulkanEngine::uploadMesh(std::span<uint32_t> indices,
             VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
             VMA_MEMORY_USAGE_GPU_ONLY);
 
-    const AllocatedBuffer staging = create_buffer(
-            vertexBufferSize + indexBufferSize,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
-
-    void* data = staging.allocation->GetMappedData();
-
-    // copy vertex buffer
-    memcpy(data, vertices.data(), vertexBufferSize);
-    // copy index buffer
-    memcpy((char*)data + vertexBufferSize, indices.data(), indexBufferSize);
-
-    command_buffers.immediate_submit([&](VkCommandBuffer cmd) {
-        VkBufferCopy vertexCopy{0};
-        vertexCopy.dstOffset = 0;
-        vertexCopy.srcOffset = 0;
-        vertexCopy.size = vertexBufferSize;
-
-        vkCmdCopyBuffer(cmd, staging.buffer, newSurface.vertexBuffer.buffer, 1,
-                        &vertexCopy);
-
-        VkBufferCopy indexCopy{0};
-        indexCopy.dstOffset = 0;
-        indexCopy.srcOffset = vertexBufferSize;
-        indexCopy.size = indexBufferSize;
-
-        vkCmdCopyBuffer(cmd, staging.buffer, newSurface.indexBuffer.buffer, 1,
-                        &indexCopy);
-            },
-            this);
-
-    // Store mesh buffers in managed collections for automatic cleanup
-    _managedBuffers.push_back(std::make_unique<VulkanBuffer>(_allocator, newSurface.vertexBuffer));
-    _managedBuffers.push_back(std::make_unique<VulkanBuffer>(_allocator, newSurface.indexBuffer));
-    destroy_buffer(staging);
+    // both copies go into the open upload batch, the first frame drawn after
+    // it is submitted waits for them on the gpu
+    uploads.upload_buffer(newSurface.vertexBuffer.buffer, 0, vertices.data(),
+                          vertexBufferSize);
+    newSurface.uploadTicket = uploads.upload_buffer(
+            newSurface.indexBuffer.buffer, 0, indices.data(), indexBufferSize);
 
+    // the buffers belong to the caller, which hands them to defer_destroy()
     return newSurface;
 }
 
@@ -749,35 +840,54 @@ void VulkanEngine::draw_imgui(VkCommandBuffer cmd,
 }
 
 void VulkanEngine::draw_geometry(VkCommandBuffer cmd) {
-    // allocate a new uniform buffer for the scene data
-    AllocatedBuffer gpuSceneDataBuffer = create_buffer(
-            sizeof(GPUSceneData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-            VMA_MEMORY_USAGE_CPU_TO_GPU);
-
-    // add it to the current frame's managed buffers for automatic cleanup
-    get_current_frame()._frameBuffers.push_back(
-        std::make_unique<VulkanBuffer>(_allocator, gpuSceneDataBuffer));
-
-    // write the buffer
-    auto* sceneUniformData =
-            (GPUSceneData*)gpuSceneDataBuffer.allocation->GetMappedData();
-    *sceneUniformData = sceneData;
-
-    // create a descriptor set that binds that buffer and update it
-    VkDescriptorSet globalDescriptor =
-            get_current_frame()._frameDescriptors.allocate(
-                    _device, _gpuSceneDataDescriptorLayout);
-
-    DescriptorWriter writer;
-    writer.write_buffer(0, gpuSceneDataBuffer.buffer, sizeof(GPUSceneData), 0,
-                        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
-    writer.update_set(_device, globalDescriptor);
+    // the scene data is the first allocation of the frame, so it always fits
+    const FrameArena::Allocation sceneDataAllocation =
+            *get_current_frame()._arena.allocate(sizeof(GPUSceneData));
+    *(GPUSceneData*)sceneDataAllocation.data = sceneData;
+
+    const VkDescriptorSet globalDescriptor =
+            get_current_frame()._sceneDescriptor;
+    const auto sceneDataOffset =
+            static_cast<uint32_t>(sceneDataAllocation.offset);
+
+    if (gpuDrivenRendering) {
+        gpuDrivenRenderer.cull(cmd, sceneData.viewproj);
+    }
 
     VkRenderingAttachmentInfo colorAttachment = vkinit::attachment_info(
             _drawImage->imageView(), nullptr, VK_IMAGE_LAYOUT_GENERAL);
 
     VkRenderingInfo renderInfo =
             vkinit::rendering_info(_drawExtent, &colorAttachment, nullptr);
+
+    stats.pipelineBinds = 0;
+    stats.pipelineBindsSkipped = 0;
+    stats.descriptorSetBinds = 0;
+    stats.descriptorSetBindsSkipped = 0;
+    stats.indexBufferBinds = 0;
+    stats.indexBufferBindsSkipped = 0;
+
+    if (!gpuDrivenRendering) {
+        prepare_opaque_batches();
+        stats.drawCount = static_cast<uint32_t>(_opaqueBatches.size());
+    }
+
+    // draw heavy frames are recorded on every thread; a render pass fed by
+    // secondary command buffers cannot record anything inline, so the whole
+    // pass lives in them
+    if (!gpuDrivenRendering && jobs.thread_count() > 1 &&
+        _opaqueBatches.size() >= 2 * kSecondaryBatchCount) {
+        record_opaque_secondaries(globalDescriptor, sceneDataOffset);
+
+        renderInfo.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
+        vkCmdBeginRendering(cmd, &renderInfo);
+        vkCmdExecuteCommands(cmd,
+                             static_cast<uint32_t>(_opaqueSecondaries.size()),
+                             _opaqueSecondaries.data());
+        vkCmdEndRendering(cmd);
+        return;
+    }
+
     vkCmdBeginRendering(cmd, &renderInfo);
 
     pipelines.trianglePipeline->bind(cmd);
@@ -813,32 +923,193 @@ void VulkanEngine::draw_geometry(VkCommandBuffer cmd) {
 
     pipelines.meshPipeline->bindDescriptorSets(cmd, &imageSet, 1);
 
-    for (const auto& [indexCount, firstIndex, indexBuffer, material, transform,
-                      vertexBufferAddress] : mainDrawContext.OpaqueSurfaces) {
-        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                          material->pipeline->pipeline);
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                material->pipeline->layout, 0, 1,
-                                &globalDescriptor, 0, nullptr);
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                material->pipeline->layout, 1, 1,
-                                &material->materialSet, 0, nullptr);
-
-        vkCmdBindIndexBuffer(cmd, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-
-        GPUDrawPushConstants pushConstants{};
-        pushConstants.vertexBuffer = vertexBufferAddress;
-        pushConstants.worldMatrix = transform;
-        vkCmdPushConstants(cmd, material->pipeline->layout,
-                           VK_SHADER_STAGE_VERTEX_BIT, 0,
-                           sizeof(GPUDrawPushConstants), &pushConstants);
-
-        vkCmdDrawIndexed(cmd, indexCount, 1, firstIndex, 0, 0);
+    if (gpuDrivenRendering) {
+        gpuDrivenRenderer.draw(cmd, globalDescriptor, sceneDataOffset);
+    } else {
+        record_opaque_batches(cmd, globalDescriptor, sceneDataOffset, 0,
+                              _opaqueBatches.size(), stats);
     }
 
     vkCmdEndRendering(cmd);
 }
 
+void VulkanEngine::prepare_opaque_batches() {
+    const std::vector<RenderObject>& surfaces = mainDrawContext.OpaqueSurfaces;
+    const std::vector<uint32_t>& order = mainDrawContext.OpaqueOrder;
+
+    _opaqueBatches.clear();
+    _opaqueInstanceBuffer = 0;
+    if (order.empty()) {
+        return;
+    }
+
+    // world matrices in recording order, so a run of identical draws reads a
+    // contiguous range of it through gl_InstanceIndex
+    const FrameArena::Allocation instances =
+            allocate_frame_data(order.size() * sizeof(GPUInstanceTransform));
+
+    auto* instanceData = (GPUInstanceTransform*)instances.data;
+    for (size_t i = 0; i < order.size(); i++) {
+        instanceData[i] =
+                GPUInstanceTransform::from_matrix(surfaces[order[i]].transform);
+    }
+    _opaqueInstanceBuffer = instances.address;
+
+    for (size_t first = 0; first < order.size();) {
+        const RenderObject& draw = surfaces[order[first]];
+
+        size_t last = first + 1;
+        while (last < order.size() &&
+               can_instance(draw, surfaces[order[last]])) {
+            last++;
+        }
+
+        _opaqueBatches.push_back({static_cast<uint32_t>(first),
+                                  static_cast<uint32_t>(last - first)});
+        first = last;
+    }
+}
+
+void VulkanEngine::record_opaque_batches(VkCommandBuffer cmd,
+                                         VkDescriptorSet globalDescriptor,
+                                         uint32_t sceneDataOffset,
+                                         std::size_t begin, std::size_t end,
+                                         EngineStats& counters) const {
+    const std::vector<RenderObject>& surfaces = mainDrawContext.OpaqueSurfaces;
+    const std::vector<uint32_t>& order = mainDrawContext.OpaqueOrder;
+
+    // state already bound on the command buffer, draws are sorted so that
+    // consecutive objects mostly share it
+    VkPipeline boundPipeline = VK_NULL_HANDLE;
+    VkPipelineLayout boundLayout = VK_NULL_HANDLE;
+    VkBuffer boundIndexBuffer = VK_NULL_HANDLE;
+
+    for (std::size_t b = begin; b < end; b++) {
+        const DrawBatch batch = _opaqueBatches[b];
+        const RenderObject& draw = surfaces[order[batch.first]];
+        const MaterialPipeline& pipeline = *draw.material->pipeline;
+
+        if (pipeline.pipeline != boundPipeline) {
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                              pipeline.pipeline);
+            boundPipeline = pipeline.pipeline;
+            counters.pipelineBinds++;
+        } else {
+            counters.pipelineBindsSkipped++;
+        }
+
+        // the scene set and the bindless material set only change with the
+        // layout, materials are selected through the push constants
+        if (pipeline.layout != boundLayout) {
+            const VkDescriptorSet sets[] = {globalDescriptor, bindless.set()};
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                    pipeline.layout, 0, 2, sets, 1,
+                                    &sceneDataOffset);
+            boundLayout = pipeline.layout;
+            counters.descriptorSetBinds++;
+        } else {
+            counters.descriptorSetBindsSkipped++;
+        }
+
+        if (draw.indexBuffer != boundIndexBuffer) {
+            vkCmdBindIndexBuffer(cmd, draw.indexBuffer, 0,
+                                 VK_INDEX_TYPE_UINT32);
+            boundIndexBuffer = draw.indexBuffer;
+            counters.indexBufferBinds++;
+        } else {
+            counters.indexBufferBindsSkipped++;
+        }
+
+        GPUInstancedDrawPushConstants pushConstants{};
+        pushConstants.vertexBuffer = draw.vertexBufferAddress;
+        pushConstants.instanceBuffer = _opaqueInstanceBuffer;
+        pushConstants.materialIndex = draw.material->materialIndex;
+        vkCmdPushConstants(cmd, pipeline.layout,
+                           VK_SHADER_STAGE_VERTEX_BIT |
+                                   VK_SHADER_STAGE_FRAGMENT_BIT,
+                           0, sizeof(GPUInstancedDrawPushConstants),
+                           &pushConstants);
+
+        vkCmdDrawIndexed(cmd, draw.indexCount, batch.count, draw.firstIndex,
+                         0, batch.first);
+    }
+}
+
+void VulkanEngine::record_opaque_secondaries(VkDescriptorSet globalDescriptor,
+                                             uint32_t sceneDataOffset) {
+    const std::size_t batchCount = _opaqueBatches.size();
+    const std::size_t bufferCount =
+            (batchCount + kSecondaryBatchCount - 1) / kSecondaryBatchCount;
+    _opaqueSecondaries.resize(bufferCount);
+    _opaqueSecondaryStats.assign(bufferCount, EngineStats{});
+
+    const VkFormat colorFormat = _drawImage->get().imageFormat;
+    const VkCommandBufferInheritanceRenderingInfo inheritanceRendering{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+            .colorAttachmentCount = 1,
+            .pColorAttachmentFormats = &colorFormat,
+            .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT};
+    const VkCommandBufferInheritanceInfo inheritance{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+            .pNext = &inheritanceRendering};
+    VkCommandBufferBeginInfo beginInfo = vkinit::command_buffer_begin_info(
+            VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+            VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT);
+    beginInfo.pInheritanceInfo = &inheritance;
+
+    // dynamic state is not inherited from the primary
+    const VkViewport viewport{
+            .x = 0.f,
+            .y = 0.f,
+            .width = static_cast<float>(_drawExtent.width),
+            .height = static_cast<float>(_drawExtent.height),
+            .minDepth = 0.f,
+            .maxDepth = 1.f};
+    const VkRect2D scissor{.offset = {0, 0}, .extent = _drawExtent};
+
+    // buffer i always holds the same batches, whichever thread records it,
+    // so executing them in index order keeps the sorted draw order
+    jobs.parallel_for(bufferCount, 1, [&](std::size_t begin, std::size_t end,
+                                          unsigned slot) {
+        for (std::size_t i = begin; i < end; i++) {
+            const VkCommandBuffer secondary =
+                    acquire_secondary_command_buffer(slot);
+            VK_CHECK(vkBeginCommandBuffer(secondary, &beginInfo));
+            vkCmdSetViewport(secondary, 0, 1, &viewport);
+            vkCmdSetScissor(secondary, 0, 1, &scissor);
+            record_opaque_batches(
+                    secondary, globalDescriptor, sceneDataOffset,
+                    i * kSecondaryBatchCount,
+                    std::min(batchCount, (i + 1) * kSecondaryBatchCount),
+                    _opaqueSecondaryStats[i]);
+            VK_CHECK(vkEndCommandBuffer(secondary));
+            _opaqueSecondaries[i] = secondary;
+        }
+    });
+
+    for (const EngineStats& counters : _opaqueSecondaryStats) {
+        stats.pipelineBinds += counters.pipelineBinds;
+        stats.pipelineBindsSkipped += counters.pipelineBindsSkipped;
+        stats.descriptorSetBinds += counters.descriptorSetBinds;
+        stats.descriptorSetBindsSkipped += counters.descriptorSetBindsSkipped;
+        stats.indexBufferBinds += counters.indexBufferBinds;
+        stats.indexBufferBindsSkipped += counters.indexBufferBindsSkipped;
+    }
+}
+
+VkCommandBuffer VulkanEngine::acquire_secondary_command_buffer(unsigned slot) {
+    SecondaryCommandPool& secondary =
+            get_current_frame()._secondaryPools[slot];
+    if (secondary.used == secondary.buffers.size()) {
+        VkCommandBufferAllocateInfo allocInfo =
+                vkinit::command_buffer_allocate_info(secondary.pool->get(), 1);
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        VK_CHECK(vkAllocateCommandBuffers(_device, &allocInfo,
+                                          &secondary.buffers.emplace_back()));
+    }
+    return secondary.buffers[secondary.used++];
+}
+
 void VulkanEngine::draw() {
     update_scene();
 
@@ -849,7 +1120,26 @@ void VulkanEngine::draw() {
 
     // Clear frame buffers instead of flushing deletion queue
     get_current_frame()._frameBuffers.clear();
+    if (get_current_frame()._arena.overflow() > 0) {
+        grow_frame_arena(get_current_frame());
+    }
+    get_current_frame()._arena.reset();
+    bindless.begin_frame(_frameNumber);
+    uploads.collect();
+
+    // this fence covered frame _frameNumber - FRAME_OVERLAP and everything
+    // before it, whatever those frames used can go now
+    if (_frameNumber >= FRAME_OVERLAP) {
+        deletionQueue.collect(_device, _frameNumber - FRAME_OVERLAP);
+    }
     get_current_frame()._frameDescriptors.clear_pools(_device);
+    for (SecondaryCommandPool& secondary :
+         get_current_frame()._secondaryPools) {
+        if (secondary.used > 0) {
+            VK_CHECK(vkResetCommandPool(_device, secondary.pool->get(), 0));
+            secondary.used = 0;
+        }
+    }
 
     VK_CHECK(vkResetFences(_device, 1, get_current_frame()._renderFence->getPtr()));
 
@@ -888,6 +1178,11 @@ void VulkanEngine::draw() {
 
     VK_CHECK(vkBeginCommandBuffer(cmd, &cmdBeginInfo));
 
+    // flush the uploads recorded since the last frame, this frame waits for
+    // them on the gpu instead of the cpu waiting after every copy
+    uploads.submit();
+    const UploadTicket uploadTicket = uploads.acquire(cmd);
+
     // transition our main draw image into general layout, so we can write into
     // it, we will overwrite it all, so we don't care about what was the older
     // layout
@@ -940,15 +1235,21 @@ void VulkanEngine::draw() {
     const VkCommandBufferSubmitInfo cmdinfo =
             vkinit::command_buffer_submit_info(cmd);
 
-    const VkSemaphoreSubmitInfo waitInfo = vkinit::semaphore_submit_info(
-            VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
-            get_current_frame()._swapchainSemaphore->get());
+    VkSemaphoreSubmitInfo waitInfos[2] = {
+            vkinit::semaphore_submit_info(
+                    VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
+                    get_current_frame()._swapchainSemaphore->get()),
+            vkinit::semaphore_submit_info(VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                                          uploads.semaphore())};
+    waitInfos[1].value = uploadTicket;
     const VkSemaphoreSubmitInfo signalInfo =
             vkinit::semaphore_submit_info(VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT,
                                           get_current_frame()._renderSemaphore->get());
 
-    const VkSubmitInfo2 submit =
-            vkinit::submit_info(&cmdinfo, &signalInfo, &waitInfo);
+    VkSubmitInfo2 submit =
+            vkinit::submit_info(&cmdinfo, &signalInfo, waitInfos);
+    // only frames that follow an upload wait on the upload timeline
+    submit.waitSemaphoreInfoCount = uploadTicket != 0 ? 2 : 1;
 
     // submit command buffer to the queue and execute it.
     //  _renderFence will now block until the graphic commands finish execution
@@ -1048,13 +1349,8 @@ AllocatedImage VulkanEngine::create_image(VkExtent3D size, VkFormat format,
 AllocatedImage VulkanEngine::create_image(const void* data, VkExtent3D size,
                                           VkFormat format,
                                           VkImageUsageFlags usage,
-                                          bool mipmapped) const {
+                                          bool mipmapped) {
     const size_t data_size = size.depth * size.width * size.height * 4;
-    const AllocatedBuffer uploadbuffer =
-            create_buffer(data_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                          VMA_MEMORY_USAGE_CPU_TO_GPU);
-
-    memcpy(uploadbuffer.info.pMappedData, data, data_size);
 
     const AllocatedImage new_image =
             create_image(size, format,
@@ -1062,34 +1358,7 @@ AllocatedImage VulkanEngine::create_image(const void* data, VkExtent3D size,
                                  VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
                          mipmapped);
 
-    command_buffers.immediate_submit([&](VkCommandBuffer cmd) {
-        vkutil::transition_image(cmd, new_image.image,
-                                 VK_IMAGE_LAYOUT_UNDEFINED,
-                                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-        VkBufferImageCopy copyRegion = {};
-        copyRegion.bufferOffset = 0;
-        copyRegion.bufferRowLength = 0;
-        copyRegion.bufferImageHeight = 0;
-
-        copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        copyRegion.imageSubresource.mipLevel = 0;
-        copyRegion.imageSubresource.baseArrayLayer = 0;
-        copyRegion.imageSubresource.layerCount = 1;
-        copyRegion.imageExtent = size;
-
-        // copy the buffer into the image
-        vkCmdCopyBufferToImage(cmd, uploadbuffer.buffer, new_image.image,
-                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
-                               &copyRegion);
-
-        vkutil::transition_image(cmd, new_image.image,
-                                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-            },
-            (VulkanEngine*)this);
-
-    destroy_buffer(uploadbuffer);
+    uploads.upload_image(new_image, size, data, data_size);
 
     return new_image;
 }
@@ -1099,34 +1368,32 @@ void VulkanEngine::destroy_image(const AllocatedImage& img) const {
     vmaDestroyImage(_allocator, img.image, img.allocation);
 }
 
-void MeshNode::Draw(const glm::mat4& topMatrix, DrawContext& ctx) {
-    const glm::mat4 nodeMatrix = topMatrix * worldTransform;
-
-    for (auto& [startIndex, count, material] : mesh->surfaces) {
-        RenderObject def{};
-        def.indexCount = count;
-        def.firstIndex = startIndex;
-        def.indexBuffer = mesh->meshBuffers.indexBuffer.buffer;
-        def.material = &material->data;
+void VulkanEngine::update_scene() {
+    const auto start = std::chrono::system_clock::now();
 
-        def.transform = nodeMatrix;
-        def.vertexBufferAddress = mesh->meshBuffers.vertexBufferAddress;
+    mainCamera->update();
 
-        ctx.OpaqueSurfaces.push_back(def);
+    glm::dvec3 origin(0.0);
+    if (largeWorldRendering) {
+        origin = glm::length(mainCamera->position - renderOrigin) >
+                                 kRenderOriginRebaseDistance
+                         ? mainCamera->position
+                         : renderOrigin;
+    }
+    if (origin != renderOrigin) {
+        renderOrigin = origin;
+        rebase_mesh_instances();
     }
 
-    ENode::Draw(topMatrix, ctx);
-}
-
-void VulkanEngine::update_scene() {
-    mainCamera->update();
+    const glm::mat4 view = mainCamera->getViewMatrix(renderOrigin);
 
-    const glm::mat4 view = mainCamera->getViewMatrix();
+    constexpr float nearPlane = 0.1f;
+    constexpr float farPlane = 10000.f;
 
     glm::mat4 projection = glm::perspective(
             glm::radians(70.f),
-            (float)_windowExtent.width / (float)_windowExtent.height, 0.1f,
-            10000.f);
+            (float)_windowExtent.width / (float)_windowExtent.height,
+            nearPlane, farPlane);
 
     // to opengl and gltf axis
     projection[1][1] *= -1;
@@ -1135,48 +1402,232 @@ void VulkanEngine::update_scene() {
     sceneData.proj = projection;
     sceneData.viewproj = projection * view;
 
-    mainDrawContext.OpaqueSurfaces.clear();
-
     sceneData.ambientColor = glm::vec4(.1f);
     sceneData.sunlightColor = glm::vec4(1.f);
     sceneData.sunlightDirection = glm::vec4(0, 1, 0.5, 1.f);
 
-    for (const auto& [key, mesh] : meshes) {
-        const std::shared_ptr<LoadedGLTF> loadedMesh = mesh;
-        loadedMesh->Draw(transforms[key], mainDrawContext);
+    if (gpuDrivenRendering) {
+        // culling happens on the gpu and the counts are not read back
+        stats.objectCount = gpuDrivenRenderer.object_count();
+        stats.culledObjectCount = 0;
+        stats.drawCount = gpuDrivenRenderer.group_count();
+
+        const auto end = std::chrono::system_clock::now();
+        stats.sceneUpdateTime =
+                std::chrono::duration<float, std::milli>(end - start).count();
+        return;
+    }
+
+    // the render proxies are kept up to date as instances change, a static
+    // scene seen from a static camera reuses last frame's draw list as is
+    stats.objectCount =
+            static_cast<uint32_t>(mainDrawContext.OpaqueSurfaces.size()) -
+            _deadRenderProxies;
+    if (_renderProxiesChanged || sceneData.viewproj != _cullViewproj) {
+        stats.culledObjectCount =
+                static_cast<uint32_t>(drawListBuilder.build(
+                        &jobs, sceneData.viewproj, view, farPlane,
+                        mainDrawContext.OpaqueSurfaces, _visibleProxies));
+        drawSorter.sort_assigned(mainDrawContext.OpaqueSurfaces,
+                                 _visibleProxies, mainDrawContext.OpaqueOrder);
+        _cullViewproj = sceneData.viewproj;
+        _renderProxiesChanged = false;
     }
-}
 
-int64_t VulkanEngine::registerMesh(const std::string& filePath) {
-    std::random_device rd;
+    const auto end = std::chrono::system_clock::now();
+    stats.sceneUpdateTime =
+            std::chrono::duration<float, std::milli>(end - start).count();
+}
 
-    // Use the Mersenne Twister engine for high-quality random numbers
-    std::mt19937_64 generator(rd());
+MeshHandle VulkanEngine::registerMesh(const std::string& filePath) {
+    const std::string structurePath = {std::string(ASSETS_DIR) + filePath};
+    const auto structureFile = assetCache.acquire(this, structurePath);
 
-    // Create a uniform distribution for int64_t
-    std::uniform_int_distribution<int64_t> distribution;
+    assert(structureFile != nullptr);
 
-    // Generate and print a random int64_t value
-    const int64_t random_int64 = distribution(generator);
+    gpuDrivenRenderer.mark_dirty();
+    MeshInstance instance{glm::mat4(1.0f), glm::dvec3(0.0), structureFile};
+    instance.transform[3] = glm::vec4(glm::vec3(-renderOrigin), 1.f);
+    add_render_proxies(instance);
+    return meshes.insert(std::move(instance));
+}
 
+void VulkanEngine::registerMeshes(const std::string& filePath,
+                                  std::span<MeshHandle> handles) {
+    if (handles.empty()) {
+        return;
+    }
     const std::string structurePath = {std::string(ASSETS_DIR) + filePath};
-    const auto structureFile = loadGltf(this, structurePath);
+    const auto structureFile = assetCache.acquire(
+            this, structurePath, static_cast<uint32_t>(handles.size()));
+
+    assert(structureFile != nullptr);
+
+    gpuDrivenRenderer.mark_dirty();
+    meshes.reserve(meshes.size() + handles.size());
+    // an exact reserve per instance would copy every proxy each time
+    mainDrawContext.OpaqueSurfaces.reserve(
+            mainDrawContext.OpaqueSurfaces.size() +
+            handles.size() * structureFile->renderList.surfaceNodes.size());
+    MeshInstance instance{glm::mat4(1.0f), glm::dvec3(0.0), structureFile};
+    instance.transform[3] = glm::vec4(glm::vec3(-renderOrigin), 1.f);
+    for (MeshHandle& handle : handles) {
+        add_render_proxies(instance);
+        handle = meshes.insert(instance);
+    }
+}
+
+void VulkanEngine::unregisterMesh(MeshHandle handle) {
+    if (const MeshInstance* mesh = meshes.get(handle)) {
+        remove_render_proxies(*mesh);
+        assetCache.release(mesh->asset->sourcePath);
+        meshes.erase(handle);
+        gpuDrivenRenderer.mark_dirty();
+
+        // dropping the holes is linear, so it waits until they are the
+        // majority
+        if (_deadRenderProxies * 2 > mainDrawContext.OpaqueSurfaces.size()) {
+            compact_render_proxies();
+        }
+    }
+}
+
+void VulkanEngine::setMeshTransform(MeshHandle handle, glm::mat4 mat) {
+    setMeshTransform(handle, glm::dmat4(mat));
+}
+
+void VulkanEngine::setMeshTransform(MeshHandle handle, const glm::dmat4& mat) {
+    MeshInstance* mesh = meshes.get(handle);
+    if (mesh != nullptr && mesh->nodeWorlds.empty()) {
+        mesh->worldPosition = glm::dvec3(mat[3]);
+        // the subtraction happens in double, only the small result is
+        // rounded to float
+        mesh->transform = glm::mat4(mat);
+        mesh->transform[3] =
+                glm::vec4(glm::vec3(mesh->worldPosition - renderOrigin), 1.f);
+        patch_render_proxies(*mesh);
+    }
+}
+
+void VulkanEngine::setMeshTransforms(std::span<const MeshHandle> handles,
+                                     std::span<const glm::mat4> mats) {
+    assert(handles.size() == mats.size());
+    for (size_t i = 0; i < handles.size(); i++) {
+        MeshInstance* mesh = meshes.get(handles[i]);
+        if (mesh == nullptr || !mesh->nodeWorlds.empty()) {
+            continue;
+        }
+        mesh->worldPosition = glm::dvec3(mats[i][3]);
+        mesh->transform = mats[i];
+        mesh->transform[3] =
+                glm::vec4(glm::vec3(mesh->worldPosition - renderOrigin), 1.f);
+        patch_render_proxies(*mesh);
+    }
+}
 
-    assert(structureFile.has_value());
+void VulkanEngine::setMeshNodeTransforms(MeshHandle handle,
+                                         std::span<const uint32_t> nodes,
+                                         std::span<const glm::dmat4> worlds) {
+    assert(nodes.size() == worlds.size());
+    MeshInstance* mesh = meshes.get(handle);
+    if (mesh == nullptr) {
+        return;
+    }
+    if (mesh->nodeWorlds.empty()) {
+        // the nodes take over the whole world matrix, the instance only
+        // keeps the render origin offset that the gpu driven path applies
+        glm::dmat4 instance(mesh->transform);
+        instance[3] = glm::dvec4(mesh->worldPosition, 1.0);
+        for (const glm::mat4& node :
+             mesh->asset->renderList.worldTransforms) {
+            mesh->nodeWorlds.push_back(instance * glm::dmat4(node));
+        }
+        mesh->worldPosition = glm::dvec3(0.0);
+        mesh->transform = glm::mat4(1.f);
+        mesh->transform[3] = glm::vec4(glm::vec3(-renderOrigin), 1.f);
+    }
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i] < mesh->nodeWorlds.size()) {
+            mesh->nodeWorlds[nodes[i]] = worlds[i];
+        }
+    }
+    patch_render_proxies(*mesh);
+    // the gpu object table holds the node matrices
+    gpuDrivenRenderer.mark_dirty();
+}
 
-    meshes[random_int64] = *structureFile;
-    transforms[random_int64] = glm::mat4(1.0f);
+void VulkanEngine::rebase_mesh_instances() {
+    // one pass over the dense instance array, rotation and scale are
+    // independent of the origin and left alone
+    for (MeshInstance& mesh : meshes.values()) {
+        mesh.transform[3] =
+                glm::vec4(glm::vec3(mesh.worldPosition - renderOrigin), 1.f);
+        patch_render_proxies(mesh);
+    }
+}
 
-    return random_int64;
+void VulkanEngine::add_render_proxies(MeshInstance& mesh) {
+    std::vector<RenderObject>& proxies = mainDrawContext.OpaqueSurfaces;
+    mesh.proxies.first = static_cast<uint32_t>(proxies.size());
+    mesh.asset->Draw(mesh.transform, mainDrawContext);
+    mesh.proxies.count =
+            static_cast<uint32_t>(proxies.size()) - mesh.proxies.first;
+    _renderProxiesChanged = true;
 }
 
-void VulkanEngine::unregisterMesh(int64_t id) {
-    if (meshes.find(id) != meshes.end()) {
-        meshes.erase(id);
-        transforms.erase(id);
+void VulkanEngine::patch_render_proxies(const MeshInstance& mesh) {
+    // proxies are in the order LoadedGLTF::Draw emits the surfaces, which is
+    // the order of its render list
+    const GLTFRenderList& list = mesh.asset->renderList;
+    RenderObject* proxies =
+            mainDrawContext.OpaqueSurfaces.data() + mesh.proxies.first;
+    if (!mesh.nodeWorlds.empty()) {
+        for (uint32_t i = 0; i < mesh.proxies.count; i++) {
+            const glm::dmat4& world = mesh.nodeWorlds[list.surfaceNodes[i]];
+            proxies[i].transform = glm::mat4(world);
+            proxies[i].transform[3] = glm::vec4(
+                    glm::vec3(glm::dvec3(world[3]) - renderOrigin), 1.f);
+        }
+    } else {
+        for (uint32_t i = 0; i < mesh.proxies.count; i++) {
+            proxies[i].transform = mesh.transform *
+                                   list.worldTransforms[list.surfaceNodes[i]];
+        }
     }
+    _renderProxiesChanged = true;
 }
 
-void VulkanEngine::setMeshTransform(int64_t id, glm::mat4 mat) {
-    transforms[id] = mat;
+void VulkanEngine::remove_render_proxies(const MeshInstance& mesh) {
+    RenderObject* proxies =
+            mainDrawContext.OpaqueSurfaces.data() + mesh.proxies.first;
+    for (uint32_t i = 0; i < mesh.proxies.count; i++) {
+        // the asset may be gone before the next compaction
+        proxies[i].material = nullptr;
+    }
+    _deadRenderProxies += mesh.proxies.count;
+    _renderProxiesChanged = true;
+}
+
+void VulkanEngine::compact_render_proxies() {
+    std::vector<RenderObject>& proxies = mainDrawContext.OpaqueSurfaces;
+    uint32_t kept = 0;
+    // ranges only ever move down, so copying in place is safe once the
+    // instances are visited in the order of their ranges
+    std::vector<MeshInstance*> ordered;
+    ordered.reserve(meshes.size());
+    for (MeshInstance& mesh : meshes.values()) {
+        ordered.push_back(&mesh);
+    }
+    std::ranges::sort(ordered, {}, [](const MeshInstance* mesh) {
+        return mesh->proxies.first;
+    });
+    for (MeshInstance* mesh : ordered) {
+        std::copy_n(proxies.begin() + mesh->proxies.first, mesh->proxies.count,
+                    proxies.begin() + kept);
+        mesh->proxies.first = kept;
+        kept += mesh->proxies.count;
+    }
+    proxies.resize(kept);
+    _deadRenderProxies = 0;
+    _renderProxiesChanged = true;
 }
@@ -0,0 +1,63 @@
+#include "graphics/vulkan/vk_frame_arena.h"
+
+#include "graphics/vulkan/vk_types.h"
+
+void FrameArena::init(VmaAllocator allocator, VkDevice device,
+                      VkDeviceSize capacity, VkDeviceSize alignment) {
+    VkBufferCreateInfo bufferInfo = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+    bufferInfo.size = capacity;
+    bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                       VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+    VmaAllocationCreateInfo vmallocinfo = {};
+    vmallocinfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    vmallocinfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    AllocatedBuffer newBuffer{};
+    VK_CHECK(vmaCreateBuffer(allocator, &bufferInfo, &vmallocinfo,
+                             &newBuffer.buffer, &newBuffer.allocation,
+                             &newBuffer.info));
+    _buffer = std::make_unique<VulkanBuffer>(allocator, newBuffer);
+
+    const VkBufferDeviceAddressInfo deviceAddressInfo{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+            .buffer = newBuffer.buffer};
+    _address = vkGetBufferDeviceAddress(device, &deviceAddressInfo);
+
+    _data = static_cast<std::byte*>(newBuffer.info.pMappedData);
+    _capacity = capacity;
+    _alignment = alignment;
+    _head = 0;
+    _overflow = 0;
+}
+
+std::unique_ptr<VulkanBuffer> FrameArena::grow(VmaAllocator allocator,
+                                               VkDevice device,
+                                               VkDeviceSize capacity) {
+    std::unique_ptr<VulkanBuffer> previous = std::move(_buffer);
+    init(allocator, device, capacity, _alignment);
+    return previous;
+}
+
+void FrameArena::destroy() {
+    _buffer.reset();
+    _data = nullptr;
+    _address = 0;
+    _capacity = 0;
+    _head = 0;
+    _overflow = 0;
+}
+
+std::optional<FrameArena::Allocation> FrameArena::allocate(VkDeviceSize size) {
+    const VkDeviceSize offset = (_head + _alignment - 1) / _alignment * _alignment;
+    if (offset + size > _capacity) {
+        _overflow += size;
+        return std::nullopt;
+    }
+
+    _head = offset + size;
+    return Allocation{_buffer->buffer(), offset, _data + offset,
+                      _address + offset};
+}
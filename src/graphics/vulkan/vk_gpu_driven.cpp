@@ -0,0 +1,375 @@
+#include "graphics/vulkan/vk_gpu_driven.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <span>
+#include <unordered_map>
+
+#include "graphics/vulkan/vk_culling.h"
+#include "graphics/vulkan/vk_engine.h"
+#include "graphics/vulkan/vk_loader.h"
+
+namespace {
+constexpr uint32_t kWorkgroupSize = 64;
+
+void memory_barrier(VkCommandBuffer cmd, VkPipelineStageFlags2 srcStage,
+                    VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage,
+                    VkAccessFlags2 dstAccess) {
+    VkMemoryBarrier2 barrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2};
+    barrier.srcStageMask = srcStage;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstStageMask = dstStage;
+    barrier.dstAccessMask = dstAccess;
+
+    VkDependencyInfo depInfo{.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+    depInfo.memoryBarrierCount = 1;
+    depInfo.pMemoryBarriers = &barrier;
+
+    vkCmdPipelineBarrier2(cmd, &depInfo);
+}
+
+uint32_t group_count_x(uint32_t count) {
+    return (count + kWorkgroupSize - 1) / kWorkgroupSize;
+}
+
+size_t hash_combine(size_t seed, size_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+}
+
+// surfaces sharing a group draw with one indirect count call
+struct GroupKey {
+    MaterialInstance* material;
+    VkBuffer indexBuffer;
+    VkDeviceAddress vertexBuffer;
+
+    bool operator==(const GroupKey&) const = default;
+};
+
+struct GroupKeyHash {
+    size_t operator()(const GroupKey& key) const {
+        size_t seed = std::hash<MaterialInstance*>{}(key.material);
+        seed = hash_combine(seed, std::hash<VkBuffer>{}(key.indexBuffer));
+        return hash_combine(seed,
+                            std::hash<VkDeviceAddress>{}(key.vertexBuffer));
+    }
+};
+
+// surfaces sharing a batch are instances of one draw command
+struct BatchKey {
+    uint32_t group;
+    uint32_t firstIndex;
+    uint32_t indexCount;
+
+    bool operator==(const BatchKey&) const = default;
+};
+
+struct BatchKeyHash {
+    size_t operator()(const BatchKey& key) const {
+        size_t seed = std::hash<uint32_t>{}(key.group);
+        seed = hash_combine(seed, std::hash<uint32_t>{}(key.firstIndex));
+        return hash_combine(seed, std::hash<uint32_t>{}(key.indexCount));
+    }
+};
+}  // namespace
+
+void GPUDrivenRenderer::init(VulkanEngine* engine) {
+    _engine = engine;
+
+    VkPushConstantRange pushRange{};
+    pushRange.offset = 0;
+    pushRange.size = sizeof(GPUCullPushConstants);
+    pushRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    ComputePipeline::ComputePipelineConfig cullConfig;
+    cullConfig.shaderPath = "./shaders/cull.comp.spv";
+    cullConfig.pushConstants.push_back(pushRange);
+
+    _cullPipeline = ComputePipeline(cullConfig);
+    _cullPipeline.init(engine->_device);
+}
+
+void GPUDrivenRenderer::destroy() {
+    _objects.reset();
+    _batches.reset();
+    _batchCounts.reset();
+    _groupCounts.reset();
+    _instances.reset();
+    _draws.reset();
+    _groups.clear();
+
+    _cullPipeline.destroy();
+}
+
+std::unique_ptr<VulkanBuffer> GPUDrivenRenderer::create_table(
+        size_t size, VkBufferUsageFlags usage, VmaMemoryUsage memoryUsage,
+        VkDeviceAddress& address) const {
+    const AllocatedBuffer buffer = _engine->create_buffer(
+            std::max<size_t>(size, 16),
+            usage | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                    VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            memoryUsage);
+
+    const VkBufferDeviceAddressInfo deviceAddressInfo{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+            .buffer = buffer.buffer};
+    address = vkGetBufferDeviceAddress(_engine->_device, &deviceAddressInfo);
+
+    return std::make_unique<VulkanBuffer>(_engine->_allocator, buffer);
+}
+
+void GPUDrivenRenderer::rebuild() {
+    // the frames in flight may still read the old tables
+    for (std::unique_ptr<VulkanBuffer>* table :
+         {&_objects, &_batches, &_batchCounts, &_groupCounts, &_instances,
+          &_draws}) {
+        if (*table) {
+            _engine->deletionQueue.push(_engine->_frameNumber,
+                                        std::move(*table));
+        }
+    }
+
+    std::vector<GPUCullObject> objects;
+    std::vector<GPUCullBatch> batches;
+    std::unordered_map<GroupKey, uint32_t, GroupKeyHash> groupIndices;
+    std::unordered_map<BatchKey, uint32_t, BatchKeyHash> batchIndices;
+    _groups.clear();
+
+    // enumerate the surfaces of every instance in asset space, the instance
+    // transform is applied on the gpu
+    DrawContext context;
+    const std::span<const MeshInstance> instances = _engine->meshes.values();
+    for (uint32_t i = 0; i < instances.size(); i++) {
+        const MeshInstance& instance = instances[i];
+        context.OpaqueSurfaces.clear();
+        instance.asset->Draw(glm::mat4(1.f), context);
+
+        for (uint32_t s = 0; s < context.OpaqueSurfaces.size(); s++) {
+            const RenderObject& object = context.OpaqueSurfaces[s];
+            // nodes driven one by one carry their whole world matrix
+            const glm::mat4 nodeMatrix =
+                    instance.nodeWorlds.empty()
+                            ? object.transform
+                            : glm::mat4(instance.nodeWorlds
+                                                [instance.asset->renderList
+                                                         .surfaceNodes[s]]);
+
+            const auto [group, groupAdded] = groupIndices.try_emplace(
+                    GroupKey{object.material, object.indexBuffer,
+                             object.vertexBufferAddress},
+                    static_cast<uint32_t>(_groups.size()));
+            if (groupAdded) {
+                _groups.push_back({object.material, object.indexBuffer,
+                                   object.vertexBufferAddress, 0, 0});
+            }
+
+            const auto [batch, batchAdded] = batchIndices.try_emplace(
+                    BatchKey{group->second, object.firstIndex,
+                             object.indexCount},
+                    static_cast<uint32_t>(batches.size()));
+            if (batchAdded) {
+                batches.push_back({object.indexCount, object.firstIndex, 0,
+                                   group->second, 0, {}});
+                _groups[group->second].batchCount++;
+            }
+            // counts the objects of the batch until the offsets are assigned
+            batches[batch->second].instanceBase++;
+
+            objects.push_back(
+                    {nodeMatrix,
+                     glm::vec4(object.bounds.origin, object.bounds.sphereRadius),
+                     i, batch->second, {}});
+        }
+    }
+
+    // every batch gets room for all of its objects and every group room for
+    // all of its batches, so the shader never has to bounds check
+    uint32_t instanceOffset = 0;
+    for (GPUCullBatch& batch : batches) {
+        const uint32_t count = batch.instanceBase;
+        batch.instanceBase = instanceOffset;
+        instanceOffset += count;
+    }
+    uint32_t drawOffset = 0;
+    for (DrawGroup& group : _groups) {
+        group.firstDraw = drawOffset;
+        drawOffset += group.batchCount;
+    }
+    for (GPUCullBatch& batch : batches) {
+        batch.firstDraw = _groups[batch.groupIndex].firstDraw;
+    }
+
+    _objectCount = static_cast<uint32_t>(objects.size());
+    _batchCount = static_cast<uint32_t>(batches.size());
+    _dirty = false;
+
+    if (_objectCount == 0) {
+        return;
+    }
+
+    _objects = create_table(objects.size() * sizeof(GPUCullObject), 0,
+                            VMA_MEMORY_USAGE_CPU_TO_GPU, _objectsAddress);
+    std::memcpy(_objects->allocation()->GetMappedData(), objects.data(),
+                objects.size() * sizeof(GPUCullObject));
+
+    _batches = create_table(batches.size() * sizeof(GPUCullBatch), 0,
+                            VMA_MEMORY_USAGE_CPU_TO_GPU, _batchesAddress);
+    std::memcpy(_batches->allocation()->GetMappedData(), batches.data(),
+                batches.size() * sizeof(GPUCullBatch));
+
+    _batchCounts = create_table(batches.size() * sizeof(uint32_t),
+                                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                VMA_MEMORY_USAGE_GPU_ONLY, _batchCountsAddress);
+    _groupCounts = create_table(
+            _groups.size() * sizeof(uint32_t),
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                    VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY, _groupCountsAddress);
+    _instances = create_table(
+            objects.size() * sizeof(GPUInstanceTransform), 0,
+            VMA_MEMORY_USAGE_GPU_ONLY, _instancesAddress);
+    _draws = create_table(
+            batches.size() * sizeof(VkDrawIndexedIndirectCommand),
+            VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY,
+            _drawsAddress);
+}
+
+void GPUDrivenRenderer::cull(VkCommandBuffer cmd, const glm::mat4& viewproj) {
+    if (_dirty) {
+        rebuild();
+    }
+    if (_objectCount == 0) {
+        return;
+    }
+
+    // instance transforms change every frame, the object table indexes them
+    // by their position in the engine's slot map
+    const std::span<const MeshInstance> instances = _engine->meshes.values();
+    const FrameArena::Allocation transforms =
+            _engine->allocate_frame_data(instances.size() *
+                                         sizeof(GPUInstanceTransform));
+
+    auto* transformData = (GPUInstanceTransform*)transforms.data;
+    for (size_t i = 0; i < instances.size(); i++) {
+        transformData[i] =
+                GPUInstanceTransform::from_matrix(instances[i].transform);
+    }
+
+    const FrameArena::Allocation paramsAllocation =
+            _engine->allocate_frame_data(sizeof(GPUCullParams));
+
+    auto* params = (GPUCullParams*)paramsAllocation.data;
+    const Frustum frustum = Frustum::from_matrix(viewproj);
+    std::ranges::copy(frustum.planes, params->planes);
+    params->objectCount = _objectCount;
+    params->batchCount = _batchCount;
+    params->objects = _objectsAddress;
+    params->batches = _batchesAddress;
+    params->transforms = transforms.address;
+    params->batchCounts = _batchCountsAddress;
+    params->groupCounts = _groupCountsAddress;
+    params->instances = _instancesAddress;
+    params->draws = _drawsAddress;
+
+    // the previous frame may still be drawing from the outputs
+    memory_barrier(cmd,
+                   VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT |
+                           VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+                   VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT |
+                           VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+                   VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT |
+                           VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                   VK_ACCESS_2_TRANSFER_WRITE_BIT |
+                           VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+
+    vkCmdFillBuffer(cmd, _batchCounts->buffer(), 0, VK_WHOLE_SIZE, 0);
+    vkCmdFillBuffer(cmd, _groupCounts->buffer(), 0, VK_WHOLE_SIZE, 0);
+
+    memory_barrier(cmd, VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+                   VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                   VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                   VK_ACCESS_2_SHADER_STORAGE_READ_BIT |
+                           VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+
+    _cullPipeline.bind(cmd);
+
+    // pass 0 culls the objects into their batches
+    GPUCullPushConstants pushConstants{};
+    pushConstants.params = paramsAllocation.address;
+    pushConstants.pass = 0;
+    _cullPipeline.pushConstants(cmd, 0, sizeof(GPUCullPushConstants),
+                                &pushConstants);
+    _cullPipeline.dispatch(cmd, group_count_x(_objectCount), 1);
+
+    memory_barrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                   VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                   VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                   VK_ACCESS_2_SHADER_STORAGE_READ_BIT |
+                           VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+
+    // pass 1 compacts the non-empty batches into draw commands
+    pushConstants.pass = 1;
+    _cullPipeline.pushConstants(cmd, 0, sizeof(GPUCullPushConstants),
+                                &pushConstants);
+    _cullPipeline.dispatch(cmd, group_count_x(_batchCount), 1);
+
+    memory_barrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                   VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                   VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT |
+                           VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+                   VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT |
+                           VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+}
+
+void GPUDrivenRenderer::draw(VkCommandBuffer cmd,
+                             VkDescriptorSet globalDescriptor,
+                             uint32_t sceneDataOffset) {
+    if (_objectCount == 0) {
+        return;
+    }
+
+    VkPipeline boundPipeline = VK_NULL_HANDLE;
+    VkPipelineLayout boundLayout = VK_NULL_HANDLE;
+    VkBuffer boundIndexBuffer = VK_NULL_HANDLE;
+
+    for (uint32_t i = 0; i < _groups.size(); i++) {
+        const DrawGroup& group = _groups[i];
+        const MaterialPipeline& pipeline = *group.material->pipeline;
+
+        if (pipeline.pipeline != boundPipeline) {
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                              pipeline.pipeline);
+            boundPipeline = pipeline.pipeline;
+        }
+        if (pipeline.layout != boundLayout) {
+            const VkDescriptorSet sets[] = {globalDescriptor,
+                                            _engine->bindless.set()};
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                    pipeline.layout, 0, 2, sets, 1,
+                                    &sceneDataOffset);
+            boundLayout = pipeline.layout;
+        }
+        if (group.indexBuffer != boundIndexBuffer) {
+            vkCmdBindIndexBuffer(cmd, group.indexBuffer, 0,
+                                 VK_INDEX_TYPE_UINT32);
+            boundIndexBuffer = group.indexBuffer;
+        }
+
+        GPUInstancedDrawPushConstants pushConstants{};
+        pushConstants.vertexBuffer = group.vertexBuffer;
+        pushConstants.instanceBuffer = _instancesAddress;
+        pushConstants.materialIndex = group.material->materialIndex;
+        vkCmdPushConstants(cmd, pipeline.layout,
+                           VK_SHADER_STAGE_VERTEX_BIT |
+                                   VK_SHADER_STAGE_FRAGMENT_BIT,
+                           0, sizeof(GPUInstancedDrawPushConstants),
+                           &pushConstants);
+
+        vkCmdDrawIndexedIndirectCount(
+                cmd, _draws->buffer(),
+                group.firstDraw * sizeof(VkDrawIndexedIndirectCommand),
+                _groupCounts->buffer(), i * sizeof(uint32_t), group.batchCount,
+                sizeof(VkDrawIndexedIndirectCommand));
+    }
+}
@@ -2,11 +2,11 @@
 
 //> init_cmd
 VkCommandPoolCreateInfo vkinit::command_pool_create_info(
-        [[maybe_unused]] uint32_t queueFamilyIndex,
-        VkCommandPoolCreateFlags flags /*= 0*/) {
+        uint32_t queueFamilyIndex, VkCommandPoolCreateFlags flags /*= 0*/) {
     VkCommandPoolCreateInfo info = {};
     info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
     info.pNext = nullptr;
+    info.queueFamilyIndex = queueFamilyIndex;
 
     info.flags = flags;
     return info;
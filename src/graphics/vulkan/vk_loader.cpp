@@ -1,5 +1,6 @@
 #include "graphics/vulkan/vk_loader.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <cstring>
@@ -11,12 +12,14 @@
 #include <fmt/base.h>
 #include <vk_mem_alloc.h>
 #define GLM_ENABLE_EXPERIMENTAL
+#include <glm/common.hpp>
 #include <glm/detail/qualifier.hpp>
 #include <glm/detail/type_mat4x4.hpp>
 #include <glm/detail/type_vec2.hpp>
 #include <glm/detail/type_vec3.hpp>
 #include <glm/detail/type_vec4.hpp>
 #include <glm/ext/quaternion_float.hpp>
+#include <glm/geometric.hpp>
 #include <glm/gtx/quaternion.hpp>
 #include <iostream>
 #include <span>
@@ -28,6 +31,28 @@
 #include "graphics/vulkan/vk_engine.h"
 #include "graphics/vulkan/vk_types.h"
 
+namespace {
+// axis aligned box around the vertices with a sphere enclosing the box
+Bounds compute_bounds(std::span<const Vertex> vertices) {
+    if (vertices.empty()) {
+        return {};
+    }
+
+    glm::vec3 minpos = vertices[0].position;
+    glm::vec3 maxpos = vertices[0].position;
+    for (const Vertex& vtx : vertices) {
+        minpos = glm::min(minpos, vtx.position);
+        maxpos = glm::max(maxpos, vtx.position);
+    }
+
+    Bounds bounds;
+    bounds.origin = (maxpos + minpos) / 2.f;
+    bounds.extents = (maxpos - minpos) / 2.f;
+    bounds.sphereRadius = glm::length(bounds.extents);
+    return bounds;
+}
+}  // namespace
+
 std::optional<std::vector<std::shared_ptr<MeshAsset>>> loadGltfMeshes(
         VulkanEngine* engine, const std::filesystem::path& filePath) {
     if (!std::filesystem::exists(filePath)) {
@@ -157,6 +182,8 @@ std::optional<std::vector<std::shared_ptr<MeshAsset>>> loadGltfMeshes(
                             vertices[initial_vtx + index].color = v;
                         });
             }
+            newSurface.bounds = compute_bounds(
+                    std::span(vertices).subspan(initial_vtx));
             newmesh.surfaces.push_back(newSurface);
         }
 
@@ -245,16 +272,6 @@ std::optional<std::shared_ptr<LoadedGLTF>> loadGltf(VulkanEngine* engine,
         return {};
     }
 
-    // Estimate descriptor pool size based on materials
-    std::vector<DescriptorAllocatorGrowable::PoolSizeRatio> sizes = {
-            {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 3},
-            {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 3},
-            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1}};
-    file.descriptorPool.init(
-            engine->_device,
-            static_cast<uint32_t>(std::max(gltf.materials.size(), size_t(1))),
-            sizes);
-
     // Load samplers
     for (fastgltf::Sampler& sampler : gltf.samplers) {
         VkSamplerCreateInfo sampl = {
@@ -284,16 +301,12 @@ std::optional<std::shared_ptr<LoadedGLTF>> loadGltf(VulkanEngine* engine,
         images.push_back(engine->_errorCheckerboardImage->get());
     }
 
-    // Create buffer to hold the material data
-    size_t materialCount = gltf.materials.size() ? gltf.materials.size() : 1;
-    file.materialDataBuffer = engine->create_buffer(
-            sizeof(GLTFMetallic_Roughness::MaterialConstants) * materialCount,
-            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
-
-    uint32_t data_index = 0;
-    auto* sceneMaterialConstants =
-            (GLTFMetallic_Roughness::MaterialConstants*)
-                    file.materialDataBuffer.info.pMappedData;
+    // every texture slot taken here is given back by clearAll()
+    auto acquireTexture = [&](VkImageView view, VkSampler sampler) {
+        const uint32_t index = engine->bindless.acquire_texture(view, sampler);
+        file.bindlessTextures.push_back(index);
+        return index;
+    };
 
     // Process all materials from the GLTF
     for (fastgltf::Material& mat : gltf.materials) {
@@ -301,7 +314,7 @@ std::optional<std::shared_ptr<LoadedGLTF>> loadGltf(VulkanEngine* engine,
         materials.push_back(newMat);
         file.materials[mat.name.c_str()] = newMat;
 
-        GLTFMetallic_Roughness::MaterialConstants constants;
+        GLTFMetallic_Roughness::MaterialConstants constants{};
         constants.colorFactors.x = mat.pbrData.baseColorFactor[0];
         constants.colorFactors.y = mat.pbrData.baseColorFactor[1];
         constants.colorFactors.z = mat.pbrData.baseColorFactor[2];
@@ -309,22 +322,13 @@ std::optional<std::shared_ptr<LoadedGLTF>> loadGltf(VulkanEngine* engine,
         constants.metal_rough_factors.x = mat.pbrData.metallicFactor;
         constants.metal_rough_factors.y = mat.pbrData.roughnessFactor;
 
-        sceneMaterialConstants[data_index] = constants;
-
         auto passType = MaterialPass::MainColor;
         if (mat.alphaMode == fastgltf::AlphaMode::Blend) {
             passType = MaterialPass::Transparent;
         }
 
-        GLTFMetallic_Roughness::MaterialResources materialResources;
-
-        materialResources.colorImage = engine->_whiteImage->get();
-        materialResources.colorSampler = engine->_defaultSamplerLinear;
-        materialResources.metalRoughImage = engine->_whiteImage->get();
-        materialResources.metalRoughSampler = engine->_defaultSamplerLinear;
-        materialResources.dataBuffer = file.materialDataBuffer.buffer;
-        materialResources.dataBufferOffset =
-                data_index * sizeof(GLTFMetallic_Roughness::MaterialConstants);
+        VkImageView colorImage = engine->_whiteImage->imageView();
+        VkSampler colorSampler = engine->_defaultSamplerLinear;
 
         if (mat.pbrData.baseColorTexture.has_value()) {
             size_t img = gltf.textures[mat.pbrData.baseColorTexture.value()
@@ -333,14 +337,20 @@ std::optional<std::shared_ptr<LoadedGLTF>> loadGltf(VulkanEngine* engine,
             size_t sampler = gltf.textures[mat.pbrData.baseColorTexture.value()
                                                    .textureIndex]
                                      .samplerIndex.value();
-            materialResources.colorImage = images[img];
-            materialResources.colorSampler = file.samplers[sampler];
+            colorImage = images[img].imageView;
+            colorSampler = file.samplers[sampler];
         }
 
+        GLTFMetallic_Roughness::MaterialResources materialResources;
+        materialResources.colorTexture =
+                acquireTexture(colorImage, colorSampler);
+        materialResources.metalRoughTexture =
+                acquireTexture(engine->_whiteImage->imageView(),
+                               engine->_defaultSamplerLinear);
+
         newMat->data = engine->metalRoughMaterial.write_material(
-                engine->_device, passType, materialResources,
-                file.descriptorPool);
-        data_index++;
+                passType, constants, materialResources, engine->bindless);
+        file.bindlessMaterials.push_back(newMat->data.materialIndex);
     }
 
     // Add a fallback material if no materials were defined in the GLTF
@@ -352,19 +362,16 @@ std::optional<std::shared_ptr<LoadedGLTF>> loadGltf(VulkanEngine* engine,
         constants.colorFactors = glm::vec4(1.0f);  // White base color
         constants.metal_rough_factors = glm::vec4(0.0f);  // Non-metallic, smooth
 
-        sceneMaterialConstants[0] = constants;
-
         GLTFMetallic_Roughness::MaterialResources resources;
-        resources.colorImage = engine->_whiteImage->get();
-        resources.colorSampler = engine->_defaultSamplerLinear;
-        resources.metalRoughImage = engine->_whiteImage->get();
-        resources.metalRoughSampler = engine->_defaultSamplerLinear;
-        resources.dataBuffer = file.materialDataBuffer.buffer;
-        resources.dataBufferOffset = 0;
+        resources.colorTexture = acquireTexture(
+                engine->_whiteImage->imageView(), engine->_defaultSamplerLinear);
+        resources.metalRoughTexture = acquireTexture(
+                engine->_whiteImage->imageView(), engine->_defaultSamplerLinear);
 
         defaultMat->data = engine->metalRoughMaterial.write_material(
-                engine->_device, MaterialPass::MainColor, resources,
-                file.descriptorPool);
+                MaterialPass::MainColor, constants, resources,
+                engine->bindless);
+        file.bindlessMaterials.push_back(defaultMat->data.materialIndex);
     }
 
     std::vector<uint32_t> indices;
@@ -373,6 +380,7 @@ std::optional<std::shared_ptr<LoadedGLTF>> loadGltf(VulkanEngine* engine,
     for (auto& [primitives, _, name] : gltf.meshes) {
         auto newmesh = std::make_shared<MeshAsset>();
         meshes.push_back(newmesh);
+        file.meshList.push_back(newmesh);
         file.meshes[name.c_str()] = newmesh;
         newmesh->name = name;
         indices.clear();
@@ -451,6 +459,9 @@ std::optional<std::shared_ptr<LoadedGLTF>> loadGltf(VulkanEngine* engine,
                 newSurface.material = materials[0];  // Always valid now
             }
 
+            newSurface.bounds = compute_bounds(
+                    std::span(vertices).subspan(initial_vtx));
+
             newmesh->surfaces.push_back(newSurface);
         }
         newmesh->meshBuffers = engine->uploadMesh(indices, vertices);
@@ -509,18 +520,120 @@ std::optional<std::shared_ptr<LoadedGLTF>> loadGltf(VulkanEngine* engine,
     for (auto& n : nodes) {
         if (n->parent.lock() == nullptr) {
             file.topNodes.push_back(n);
-            n->refreshTransform(glm::mat4{1.f});
         }
     }
 
+    file.build_render_list();
+    file.refresh_transforms();
+
     return scene;
 }
 
 void LoadedGLTF::Draw(const glm::mat4& topMatrix, DrawContext& ctx) {
-    // create renderables from the scenenodes
-    for (const auto& n : topNodes) {
-        n->Draw(topMatrix, ctx);
+    const GLTFRenderList& list = renderList;
+    const size_t surfaceCount = list.surfaceNodes.size();
+
+    // surfaces of one node are adjacent, so its matrix is multiplied once
+    uint32_t currentNode = GLTFRenderList::kNoParent;
+    glm::mat4 nodeMatrix;
+    for (size_t i = 0; i < surfaceCount; i++) {
+        if (list.surfaceNodes[i] != currentNode) {
+            currentNode = list.surfaceNodes[i];
+            nodeMatrix = topMatrix * list.worldTransforms[currentNode];
+        }
+
+        RenderObject& def = ctx.OpaqueSurfaces.emplace_back();
+        def.indexCount = list.indexCounts[i];
+        def.firstIndex = list.firstIndices[i];
+        def.indexBuffer = list.indexBuffers[i];
+        def.material = list.materials[i];
+        def.bounds = list.bounds[i];
+        def.transform = nodeMatrix;
+        def.vertexBufferAddress = list.vertexBufferAddresses[i];
     }
 }
 
-void LoadedGLTF::clearAll() {}
+void LoadedGLTF::build_render_list() {
+    renderList = {};
+    GLTFRenderList& list = renderList;
+
+    struct Pending {
+        ENode* node;
+        uint32_t parent;
+    };
+    std::vector<Pending> stack;
+    for (auto it = topNodes.rbegin(); it != topNodes.rend(); ++it) {
+        stack.push_back({it->get(), GLTFRenderList::kNoParent});
+    }
+    while (!stack.empty()) {
+        const Pending current = stack.back();
+        stack.pop_back();
+
+        const auto index = static_cast<uint32_t>(list.nodes.size());
+        list.nodes.push_back(current.node);
+        list.localTransforms.push_back(current.node->localTransform);
+        list.worldTransforms.push_back(glm::mat4(1.f));
+        list.parents.push_back(current.parent);
+
+        if (const auto* meshNode = dynamic_cast<const MeshNode*>(current.node)) {
+            const MeshAsset& mesh = *meshNode->mesh;
+            for (const GeoSurface& surface : mesh.surfaces) {
+                list.surfaceNodes.push_back(index);
+                list.firstIndices.push_back(surface.startIndex);
+                list.indexCounts.push_back(surface.count);
+                list.bounds.push_back(surface.bounds);
+                list.materials.push_back(&surface.material->data);
+                list.indexBuffers.push_back(mesh.meshBuffers.indexBuffer.buffer);
+                list.vertexBufferAddresses.push_back(
+                        mesh.meshBuffers.vertexBufferAddress);
+            }
+        }
+
+        const auto& children = current.node->children;
+        for (auto it = children.rbegin(); it != children.rend(); ++it) {
+            stack.push_back({it->get(), index});
+        }
+    }
+}
+
+void LoadedGLTF::refresh_transforms() {
+    GLTFRenderList& list = renderList;
+    // parents precede children, so every parent matrix is already composed
+    for (size_t i = 0; i < list.nodes.size(); i++) {
+        const uint32_t parent = list.parents[i];
+        list.worldTransforms[i] =
+                parent == GLTFRenderList::kNoParent
+                        ? list.localTransforms[i]
+                        : list.worldTransforms[parent] * list.localTransforms[i];
+
+        ENode& node = *list.nodes[i];
+        node.worldTransform = list.worldTransforms[i];
+    }
+}
+
+void LoadedGLTF::clearAll() {
+    if (!creator) {
+        return;
+    }
+
+    // frames in flight may still draw these, the engine frees them once
+    // their fences have signalled
+    for (const std::shared_ptr<MeshAsset>& mesh : meshList) {
+        creator->defer_destroy(mesh->meshBuffers);
+    }
+    for (const VkSampler sampler : samplers) {
+        creator->defer_destroy(sampler);
+    }
+    meshes.clear();
+    meshList.clear();
+    samplers.clear();
+
+    for (const uint32_t material : bindlessMaterials) {
+        creator->bindless.remove_material(material);
+    }
+    for (const uint32_t texture : bindlessTextures) {
+        creator->bindless.release_texture(texture);
+    }
+    bindlessMaterials.clear();
+    bindlessTextures.clear();
+}
@@ -0,0 +1,329 @@
+#include "graphics/vulkan/vk_upload.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "graphics/vulkan/vk_engine.h"
+#include "graphics/vulkan/vk_initializers.h"
+
+namespace {
+// covers the texel size of every format and optimalBufferCopyOffsetAlignment
+// on common hardware
+constexpr VkDeviceSize kStagingAlignment = 16;
+// full size pages kept once their batch completed
+constexpr size_t kMaxFreePages = 4;
+
+VkDeviceSize align_up(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+}  // namespace
+
+void UploadManager::init(VulkanEngine* engine, VkQueue queue,
+                         uint32_t queueFamily) {
+    _engine = engine;
+    _queue = queue;
+    _queueFamily = queueFamily;
+    _graphicsQueueFamily = engine->_graphicsQueueFamily;
+
+    const VkCommandPoolCreateInfo poolInfo = vkinit::command_pool_create_info(
+            _queueFamily, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+    VK_CHECK(vkCreateCommandPool(engine->_device, &poolInfo, nullptr, &_pool));
+
+    VkSemaphoreTypeCreateInfo typeInfo = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO};
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo = vkinit::semaphore_create_info();
+    semaphoreInfo.pNext = &typeInfo;
+    VK_CHECK(vkCreateSemaphore(engine->_device, &semaphoreInfo, nullptr,
+                               &_timeline));
+
+    _nextTicket = 1;
+    _lastSubmitted = 0;
+    _lastAcquired = 0;
+}
+
+void UploadManager::destroy() {
+    if (!_engine) {
+        return;
+    }
+
+    wait(submit());
+    collect();
+
+    vkDestroyCommandPool(_engine->_device, _pool, nullptr);
+    vkDestroySemaphore(_engine->_device, _timeline, nullptr);
+    _pool = VK_NULL_HANDLE;
+    _timeline = VK_NULL_HANDLE;
+    _bufferAcquires.clear();
+    _imageAcquires.clear();
+    _freePages.clear();
+    _engine = nullptr;
+}
+
+UploadManager::Batch& UploadManager::open_batch() {
+    if (_open) {
+        return *_open;
+    }
+
+    _open = std::make_unique<Batch>();
+    _open->ticket = _nextTicket++;
+
+    const VkCommandBufferAllocateInfo allocInfo =
+            vkinit::command_buffer_allocate_info(_pool, 1);
+    VK_CHECK(vkAllocateCommandBuffers(_engine->_device, &allocInfo,
+                                      &_open->cmd));
+
+    const VkCommandBufferBeginInfo beginInfo = vkinit::command_buffer_begin_info(
+            VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    VK_CHECK(vkBeginCommandBuffer(_open->cmd, &beginInfo));
+
+    return *_open;
+}
+
+UploadManager::StagingPage UploadManager::take_page(VkDeviceSize size) {
+    if (size <= kStagingPageSize && !_freePages.empty()) {
+        StagingPage page = std::move(_freePages.back());
+        _freePages.pop_back();
+        return page;
+    }
+
+    const VkDeviceSize pageSize = std::max(size, kStagingPageSize);
+    const AllocatedBuffer buffer = _engine->create_buffer(
+            pageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VMA_MEMORY_USAGE_CPU_ONLY);
+    return {std::make_unique<VulkanBuffer>(_engine->_allocator, buffer),
+            pageSize};
+}
+
+UploadManager::StagingRange UploadManager::stage(Batch& batch,
+                                                 const void* data,
+                                                 VkDeviceSize size) {
+    VkDeviceSize offset = align_up(batch.stagingUsed, kStagingAlignment);
+    if (batch.staging.empty() || offset + size > batch.staging.back().size) {
+        batch.staging.push_back(take_page(size));
+        offset = 0;
+    }
+
+    const StagingPage& page = batch.staging.back();
+    memcpy(static_cast<char*>(page.buffer->get().info.pMappedData) + offset,
+           data, size);
+    batch.stagingUsed = offset + size;
+    return {page.buffer->buffer(), offset};
+}
+
+UploadTicket UploadManager::upload_buffer(VkBuffer dst, VkDeviceSize dstOffset,
+                                          const void* data,
+                                          VkDeviceSize size) {
+    if (size == 0) {
+        return _lastSubmitted;
+    }
+
+    Batch& batch = open_batch();
+    const StagingRange staging = stage(batch, data, size);
+
+    VkBufferCopy copy{};
+    copy.srcOffset = staging.offset;
+    copy.dstOffset = dstOffset;
+    copy.size = size;
+    vkCmdCopyBuffer(batch.cmd, staging.buffer, dst, 1, &copy);
+
+    // same family: the timeline semaphore wait already makes the copy
+    // visible, only a queue family change needs barriers
+    if (!dedicated_queue_family()) {
+        return batch.ticket;
+    }
+
+    VkBufferMemoryBarrier2 release{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2};
+    release.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    release.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    release.srcQueueFamilyIndex = _queueFamily;
+    release.dstQueueFamilyIndex = _graphicsQueueFamily;
+    release.buffer = dst;
+    release.offset = dstOffset;
+    release.size = size;
+
+    VkDependencyInfo depInfo{.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+    depInfo.bufferMemoryBarrierCount = 1;
+    depInfo.pBufferMemoryBarriers = &release;
+    vkCmdPipelineBarrier2(batch.cmd, &depInfo);
+
+    VkBufferMemoryBarrier2 acquire = release;
+    acquire.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+    acquire.srcAccessMask = VK_ACCESS_2_NONE;
+    acquire.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+    acquire.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+    batch.bufferAcquires.push_back(acquire);
+
+    return batch.ticket;
+}
+
+UploadTicket UploadManager::upload_image(const AllocatedImage& image,
+                                         VkExtent3D extent, const void* data,
+                                         VkDeviceSize size) {
+    Batch& batch = open_batch();
+    const StagingRange staging = stage(batch, data, size);
+
+    VkImageMemoryBarrier2 toTransfer{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2};
+    toTransfer.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+    toTransfer.srcAccessMask = VK_ACCESS_2_NONE;
+    toTransfer.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    toTransfer.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    toTransfer.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toTransfer.image = image.image;
+    toTransfer.subresourceRange =
+            vkinit::image_subresource_range(VK_IMAGE_ASPECT_COLOR_BIT);
+
+    VkDependencyInfo depInfo{.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+    depInfo.imageMemoryBarrierCount = 1;
+    depInfo.pImageMemoryBarriers = &toTransfer;
+    vkCmdPipelineBarrier2(batch.cmd, &depInfo);
+
+    VkBufferImageCopy copyRegion = {};
+    copyRegion.bufferOffset = staging.offset;
+    copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    copyRegion.imageSubresource.mipLevel = 0;
+    copyRegion.imageSubresource.baseArrayLayer = 0;
+    copyRegion.imageSubresource.layerCount = 1;
+    copyRegion.imageExtent = extent;
+    vkCmdCopyBufferToImage(batch.cmd, staging.buffer, image.image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
+                           &copyRegion);
+
+    // the layout change happens once, in the release on a dedicated family
+    // or in a plain barrier otherwise
+    VkImageMemoryBarrier2 toShader = toTransfer;
+    toShader.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    toShader.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    toShader.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    toShader.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    if (dedicated_queue_family()) {
+        toShader.dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+        toShader.dstAccessMask = VK_ACCESS_2_NONE;
+        toShader.srcQueueFamilyIndex = _queueFamily;
+        toShader.dstQueueFamilyIndex = _graphicsQueueFamily;
+
+        VkImageMemoryBarrier2 acquire = toShader;
+        acquire.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+        acquire.srcAccessMask = VK_ACCESS_2_NONE;
+        acquire.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        acquire.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+        batch.imageAcquires.push_back(acquire);
+    } else {
+        toShader.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        toShader.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+    }
+
+    depInfo.pImageMemoryBarriers = &toShader;
+    vkCmdPipelineBarrier2(batch.cmd, &depInfo);
+
+    return batch.ticket;
+}
+
+UploadTicket UploadManager::submit() {
+    if (!_open) {
+        return _lastSubmitted;
+    }
+
+    std::unique_ptr<Batch> batch = std::move(_open);
+    VK_CHECK(vkEndCommandBuffer(batch->cmd));
+
+    const VkCommandBufferSubmitInfo cmdInfo =
+            vkinit::command_buffer_submit_info(batch->cmd);
+    VkSemaphoreSubmitInfo signalInfo = vkinit::semaphore_submit_info(
+            VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, _timeline);
+    signalInfo.value = batch->ticket;
+
+    const VkSubmitInfo2 submitInfo =
+            vkinit::submit_info(&cmdInfo, &signalInfo, nullptr);
+    VK_CHECK(vkQueueSubmit2(_queue, 1, &submitInfo, VK_NULL_HANDLE));
+
+    _bufferAcquires.insert(_bufferAcquires.end(),
+                           batch->bufferAcquires.begin(),
+                           batch->bufferAcquires.end());
+    _imageAcquires.insert(_imageAcquires.end(), batch->imageAcquires.begin(),
+                          batch->imageAcquires.end());
+    batch->bufferAcquires.clear();
+    batch->imageAcquires.clear();
+
+    _lastSubmitted = batch->ticket;
+    _inFlight.push_back(std::move(batch));
+    return _lastSubmitted;
+}
+
+UploadTicket UploadManager::acquire(VkCommandBuffer cmd) {
+    if (_lastAcquired == _lastSubmitted) {
+        return 0;
+    }
+
+    if (!_bufferAcquires.empty() || !_imageAcquires.empty()) {
+        VkDependencyInfo depInfo{.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+        depInfo.bufferMemoryBarrierCount =
+                static_cast<uint32_t>(_bufferAcquires.size());
+        depInfo.pBufferMemoryBarriers = _bufferAcquires.data();
+        depInfo.imageMemoryBarrierCount =
+                static_cast<uint32_t>(_imageAcquires.size());
+        depInfo.pImageMemoryBarriers = _imageAcquires.data();
+        vkCmdPipelineBarrier2(cmd, &depInfo);
+
+        _bufferAcquires.clear();
+        _imageAcquires.clear();
+    }
+
+    _lastAcquired = _lastSubmitted;
+    return _lastAcquired;
+}
+
+void UploadManager::collect() {
+    if (_inFlight.empty()) {
+        return;
+    }
+
+    uint64_t reached = 0;
+    VK_CHECK(vkGetSemaphoreCounterValue(_engine->_device, _timeline,
+                                        &reached));
+
+    // batches complete in submission order
+    size_t done = 0;
+    while (done < _inFlight.size() && _inFlight[done]->ticket <= reached) {
+        vkFreeCommandBuffers(_engine->_device, _pool, 1,
+                             &_inFlight[done]->cmd);
+        for (StagingPage& page : _inFlight[done]->staging) {
+            if (page.size == kStagingPageSize &&
+                _freePages.size() < kMaxFreePages) {
+                _freePages.push_back(std::move(page));
+            }
+        }
+        done++;
+    }
+    _inFlight.erase(_inFlight.begin(), _inFlight.begin() + done);
+}
+
+bool UploadManager::is_complete(UploadTicket ticket) const {
+    uint64_t reached = 0;
+    VK_CHECK(vkGetSemaphoreCounterValue(_engine->_device, _timeline,
+                                        &reached));
+    return reached >= ticket;
+}
+
+void UploadManager::wait(UploadTicket ticket) {
+    if (_open && ticket >= _open->ticket) {
+        submit();
+    }
+    if (ticket == 0) {
+        return;
+    }
+
+    VkSemaphoreWaitInfo waitInfo = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO};
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &_timeline;
+    waitInfo.pValues = &ticket;
+    VK_CHECK(vkWaitSemaphores(_engine->_device, &waitInfo, UINT64_MAX));
+}
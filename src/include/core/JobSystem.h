@@ -0,0 +1,58 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** @brief Fixed pool of worker threads running data-parallel loops.
+ *
+ * @details parallel_for() splits a range into chunks that the workers and the
+ * calling thread take from a shared atomic counter, and returns once every
+ * chunk has run. Each call gets a slot number below thread_count(), unique
+ * among the threads taking part, so callers can keep per-thread scratch
+ * storage without locking. Only one loop runs at a time; calls from several
+ * threads are serialized.
+ * */
+class JobSystem {
+public:
+    /** @param threadCount threads taking part in a loop, the caller
+     * included. 0 uses every hardware thread.
+     * */
+    explicit JobSystem(unsigned threadCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /** @brief Runs fn(begin, end, slot) over [0, count) in chunks of at
+     * least grain elements.
+     * */
+    void parallel_for(
+            std::size_t count, std::size_t grain,
+            const std::function<void(std::size_t, std::size_t, unsigned)>& fn);
+
+    [[nodiscard]] unsigned thread_count() const {
+        return static_cast<unsigned>(_workers.size()) + 1;
+    }
+
+private:
+    struct Loop;
+
+    void worker_main(unsigned slot);
+    static void run_chunks(Loop& loop, unsigned slot);
+
+    std::vector<std::thread> _workers;
+
+    std::mutex _submitMutex;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    Loop* _loop = nullptr;
+    uint64_t _generation = 0;
+    unsigned _busyWorkers = 0;
+    bool _stop = false;
+};
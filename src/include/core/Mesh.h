@@ -18,8 +18,19 @@ public:
     void set_transform(glm::mat4 t);
     glm::mat4 get_transform();
 
+    // records a transform already written to the engine through handle(), so
+    // that set_model() reapplies it
+    void sync_transform(const glm::mat4& t) {
+        _transform = t;
+    }
+
+    // a new handle is registered by every set_model()
+    MeshHandle handle() const {
+        return _rid;
+    }
+
 private:
     glm::mat4 _transform;
     std::string _currentModelPath;  // Track current model path
-    int64_t _rid;
+    MeshHandle _rid;
 };
\ No newline at end of file
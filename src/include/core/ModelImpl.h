@@ -4,6 +4,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "graphics/vulkan/vk_engine.h"
 #include "interfaces/IModel.h"
@@ -26,12 +27,24 @@ public:
     void updateVulkan() override;
 
     void createMesh(std::string name) override;
-    void setMeshTransform(std::string name, glm::mat4x4 transform) override;
+    void setMeshTransform(const std::string &name,
+                          const glm::mat4x4 &transform) override;
+
+    void createMeshes(std::span<MeshHandle> handles) override;
+    [[nodiscard]] MeshHandle getMeshHandle(
+            const std::string &name) const override;
+    void setMeshTransforms(std::span<const MeshHandle> handles,
+                           std::span<const glm::mat4> transforms) override;
 
     Camera *getCamera() override;
 
 private:
     std::unordered_map<std::string, std::shared_ptr<Mesh>> _meshes;
+    // named meshes by handle, to keep their transform in sync when they are
+    // written through setMeshTransforms()
+    std::unordered_map<MeshHandle, Mesh *> _namedHandles;
+    // created through createMeshes(), released with the model
+    std::vector<MeshHandle> _unnamedMeshes;
 
     VulkanEngine _engine;
 
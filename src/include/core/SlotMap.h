@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+/** @brief Handle to a SlotMap element.
+ *
+ * @details The low 32 bits hold the slot index and the high 32 bits hold the
+ * generation of the slot at the time the element was inserted, so a handle to
+ * an erased element never resolves to whatever reuses its slot.
+ * */
+using SlotHandle = std::uint64_t;
+
+/** @brief A handle that never refers to a live element. **/
+constexpr SlotHandle kInvalidSlotHandle = 0;
+
+/** @brief Container with stable generational handles and dense storage.
+ *
+ * @details Values are kept contiguous in insertion order until an erase
+ * swaps the last value into the hole, so iteration is a linear walk over
+ * values() and insert, erase and lookup are all O(1).
+ *
+ * @tparam T stored value type, must be move-assignable.
+ * */
+template <typename T>
+class SlotMap {
+public:
+    /** @brief Inserts a value and returns its handle. **/
+    SlotHandle insert(T value) {
+        return emplace(std::move(value));
+    }
+
+    /** @brief Constructs a value in place and returns its handle. **/
+    template <typename... Args>
+    SlotHandle emplace(Args&&... args) {
+        uint32_t index;
+        if (_freeHead != kNoSlot) {
+            index = _freeHead;
+            _freeHead = _slots[index].denseIndex;
+        } else {
+            index = static_cast<uint32_t>(_slots.size());
+            _slots.push_back({kNoSlot, 1});
+        }
+
+        Slot& slot = _slots[index];
+        slot.denseIndex = static_cast<uint32_t>(_values.size());
+
+        const SlotHandle handle = make_handle(index, slot.generation);
+        _values.emplace_back(std::forward<Args>(args)...);
+        _handles.push_back(handle);
+
+        return handle;
+    }
+
+    /** @brief Erases the value behind a handle.
+     * @return false if the handle was stale or invalid.
+     * */
+    bool erase(SlotHandle handle) {
+        if (!contains(handle)) {
+            return false;
+        }
+
+        const uint32_t index = slot_index(handle);
+        Slot& slot = _slots[index];
+        const uint32_t hole = slot.denseIndex;
+        const uint32_t last = static_cast<uint32_t>(_values.size() - 1);
+
+        if (hole != last) {
+            _values[hole] = std::move(_values[last]);
+            _handles[hole] = _handles[last];
+            _slots[slot_index(_handles[hole])].denseIndex = hole;
+        }
+        _values.pop_back();
+        _handles.pop_back();
+
+        erase_slot(index);
+
+        return true;
+    }
+
+    [[nodiscard]] bool contains(SlotHandle handle) const {
+        const uint32_t index = slot_index(handle);
+        if (index >= _slots.size()) {
+            return false;
+        }
+        const Slot& slot = _slots[index];
+        return slot.generation == slot_generation(handle) &&
+               slot.denseIndex < _handles.size() &&
+               _handles[slot.denseIndex] == handle;
+    }
+
+    /** @brief Returns the value behind a handle, or nullptr if it is stale. **/
+    [[nodiscard]] T* get(SlotHandle handle) {
+        return contains(handle) ? &_values[_slots[slot_index(handle)].denseIndex]
+                                : nullptr;
+    }
+
+    [[nodiscard]] const T* get(SlotHandle handle) const {
+        return contains(handle) ? &_values[_slots[slot_index(handle)].denseIndex]
+                                : nullptr;
+    }
+
+    /** @brief Position of the value in values(), valid until the next erase.
+     * @return kNoSlot if the handle is stale.
+     * */
+    [[nodiscard]] uint32_t dense_index(SlotHandle handle) const {
+        return contains(handle) ? _slots[slot_index(handle)].denseIndex
+                                : kNoSlot;
+    }
+
+    /** @brief All live values, contiguous. **/
+    [[nodiscard]] std::span<T> values() {
+        return _values;
+    }
+
+    [[nodiscard]] std::span<const T> values() const {
+        return _values;
+    }
+
+    /** @brief Handles of the live values, parallel to values(). **/
+    [[nodiscard]] std::span<const SlotHandle> handles() const {
+        return _handles;
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return _values.size();
+    }
+
+    [[nodiscard]] bool empty() const {
+        return _values.empty();
+    }
+
+    void reserve(std::size_t capacity) {
+        _slots.reserve(capacity);
+        _values.reserve(capacity);
+        _handles.reserve(capacity);
+    }
+
+    /** @brief Erases every value; all outstanding handles become stale. **/
+    void clear() {
+        for (const SlotHandle handle : _handles) {
+            erase_slot(slot_index(handle));
+        }
+        _values.clear();
+        _handles.clear();
+    }
+
+    static constexpr uint32_t kNoSlot = std::numeric_limits<uint32_t>::max();
+
+private:
+    struct Slot {
+        // index into _values while occupied, next free slot while free
+        uint32_t denseIndex;
+        uint32_t generation;
+    };
+
+    static constexpr SlotHandle make_handle(uint32_t index,
+                                            uint32_t generation) {
+        return (static_cast<SlotHandle>(generation) << 32) | index;
+    }
+
+    static constexpr uint32_t slot_index(SlotHandle handle) {
+        return static_cast<uint32_t>(handle & 0xFFFFFFFFu);
+    }
+
+    static constexpr uint32_t slot_generation(SlotHandle handle) {
+        return static_cast<uint32_t>(handle >> 32);
+    }
+
+    void erase_slot(uint32_t index) {
+        Slot& slot = _slots[index];
+        // generation 0 is reserved so that kInvalidSlotHandle never resolves
+        if (++slot.generation == 0) {
+            slot.generation = 1;
+        }
+        slot.denseIndex = _freeHead;
+        _freeHead = index;
+    }
+
+    std::vector<Slot> _slots;
+    std::vector<T> _values;
+    std::vector<SlotHandle> _handles;
+    uint32_t _freeHead = kNoSlot;
+};
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <map>
+#include <span>
+
+#include "core/SlotMap.h"
 
 namespace engine::graphics {
 
@@ -19,19 +22,36 @@ public:
     static Graphics *getInstance();
 
     /** @brief Creates a mesh instance and returns its ID.
-     * @details All mesh instance parameters are set to default.
+     * @details All mesh instance parameters are set to default. IDs are
+     * generational, so the ID of a freed instance is never valid again.
      * */
 
     std::uint64_t create_mesh_instance();
 
     /** @brief CSets the transformation matrix to the mesh instance by ID.
+     * @details The matrix is stored in double precision.
      * @param rid Mesh Instance Rendering ID.
      * @param matrix New matrix.
      * */
 
-    void set_mesh_instance_transform(std::uint64_t rid, glm::mat4 matrix);
+    void set_mesh_instance_transform(std::uint64_t rid,
+                                     const glm::dmat4 &matrix);
+
+    /** @brief Sets the transformation matrices of many mesh instances at
+     * once.
+     * @details Matrix i goes to instance rids[i]; both spans have the same
+     * size. Meant for systems forwarding a frame's worth of changes in one
+     * call instead of one call per instance.
+     * @param rids Mesh Instance Rendering IDs.
+     * @param matrices New matrices.
+     * */
 
-    /** @brief Destroys a mesh instance by its ID. **/
+    void set_mesh_instance_transforms(std::span<const std::uint64_t> rids,
+                                      std::span<const glm::dmat4> matrices);
+
+    /** @brief Destroys a mesh instance by its ID, in O(1).
+     * @details Its ID stays invalid, other IDs are unaffected.
+     * */
 
     void free_mesh_instance(std::uint64_t rid);
 
@@ -41,7 +61,7 @@ private:
     /*! \brief ctor */
     Graphics() = default;
 
-    std::map<std::uint64_t, std::uint64_t> meshes;
+    SlotMap<glm::dmat4> instances;
 };
 
 }  // namespace engine::graphics
\ No newline at end of file
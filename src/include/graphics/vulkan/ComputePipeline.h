@@ -5,12 +5,16 @@
 #include "vk_initializers.h"
 #include "vk_pipelines.h"
 #include <functional>
+#include <string>
+#include <vector>
 
 class ComputePipeline : public IPipeline {
 public:
     struct ComputePipelineConfig {
-        VkDescriptorSetLayout descriptorSetLayout;
+        // VK_NULL_HANDLE for shaders that only read through push constants
+        VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
         std::string shaderPath;
+        std::vector<VkPushConstantRange> pushConstants;
         std::function<void(VkDevice, VkPipeline, VkPipelineLayout)> customSetupCallback = nullptr;
     };
 
@@ -27,6 +31,7 @@ public:
     // Specific to compute pipelines
     void dispatch(VkCommandBuffer cmd, uint32_t x, uint32_t y, uint32_t z = 1);
     void bindDescriptorSets(VkCommandBuffer cmd, const VkDescriptorSet* descriptorSets, uint32_t setCount);
+    void pushConstants(VkCommandBuffer cmd, uint32_t offset, uint32_t size, const void* data);
 
 private:
     VkDevice _device = VK_NULL_HANDLE;
@@ -11,42 +11,39 @@
 #include "GraphicsPipeline.h"
 #include "ComputePipeline.h"
 
+class BindlessRegistry;
 class VulkanEngine;
 
 struct GLTFMetallic_Roughness {
     MaterialPipeline opaquePipeline;
     MaterialPipeline transparentPipeline;
 
-    VkDescriptorSetLayout materialLayout;
-
+    // one entry of the bindless material buffer, laid out as MaterialData in
+    // input_structures.glsl
     struct MaterialConstants {
         glm::vec4 colorFactors;
         glm::vec4 metal_rough_factors;
-        glm::vec4 extra[14];
+        uint32_t colorTexture;
+        uint32_t metalRoughTexture;
+        uint32_t pad[2];
     };
 
+    // bindless texture indices, acquired by the owner of the material
     struct MaterialResources {
-        AllocatedImage colorImage;
-        VkSampler colorSampler;
-        AllocatedImage metalRoughImage;
-        VkSampler metalRoughSampler;
-        VkBuffer dataBuffer;
-        uint32_t dataBufferOffset;
+        uint32_t colorTexture;
+        uint32_t metalRoughTexture;
     };
 
-    DescriptorWriter writer;
-
     void build_pipelines(VulkanEngine* engine);
     void clear_resources(VkDevice device);
-    MaterialInstance write_material(
-            VkDevice device, MaterialPass pass,
-            const MaterialResources& resources,
-            DescriptorAllocatorGrowable& descriptorAllocator);
+    MaterialInstance write_material(MaterialPass pass,
+                                    MaterialConstants constants,
+                                    const MaterialResources& resources,
+                                    BindlessRegistry& registry);
 
 private:
     VkShaderModule load_shader(VulkanEngine* engine, const char* path,
                                const char* type);
-    void create_material_layout(VulkanEngine* engine);
     VkPipelineLayout create_pipeline_layout(VulkanEngine* engine);
     void build_opaque_pipeline(VulkanEngine* engine,
                                VkShaderModule vertexShader,
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+class VulkanEngine;
+struct LoadedGLTF;
+
+/** @brief Path-keyed cache of loaded glTF files.
+ *
+ * @details Every mesh instance registered in the engine holds one reference
+ * on the file it was created from, so any number of instances share a single
+ * set of samplers, materials and GPU buffers. The file is evicted as soon as
+ * the last reference is released.
+ * */
+class GLTFAssetCache {
+public:
+    /** @brief Returns the cached file for the path, loading it on first use.
+     * @param references references taken at once, one per instance that
+     * will later release the file.
+     * @return nullptr if the file could not be loaded.
+     * */
+    std::shared_ptr<LoadedGLTF> acquire(VulkanEngine* engine,
+                                        const std::string& filePath,
+                                        uint32_t references = 1);
+
+    /** @brief Drops one reference, evicting the file when none are left. **/
+    void release(const std::string& filePath);
+
+    /** @brief Drops every file regardless of outstanding references. **/
+    void clear();
+
+    [[nodiscard]] std::size_t size() const;
+
+    [[nodiscard]] uint32_t ref_count(const std::string& filePath) const;
+
+private:
+    struct Entry {
+        std::shared_ptr<LoadedGLTF> asset;
+        uint32_t refCount;
+    };
+
+    static std::string make_key(const std::string& filePath);
+
+    std::unordered_map<std::string, Entry> _entries;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "pipelines.h"
+#include "vk_smart_wrappers.h"
+
+class VulkanEngine;
+
+/** @brief Global update-after-bind descriptor set holding every material and
+ * texture.
+ *
+ * @details Binding 0 is a storage buffer with one MaterialConstants entry per
+ * material, binding 1 a partially bound array of combined image samplers.
+ * Shaders index both with the material index pushed per draw, so a frame
+ * binds the set once per pipeline layout instead of once per material.
+ *
+ * Textures are deduplicated by (view, sampler) and reference counted.
+ * Released slots are only reused FRAME_OVERLAP frames later, so a frame still
+ * in flight never sees a slot being rewritten underneath it.
+ *
+ * Slot 0 of either table belongs to the first texture and material added,
+ * which the engine keeps for its whole lifetime. It is never released and
+ * is handed out instead of failing once a table is full.
+ * */
+class BindlessRegistry {
+public:
+    static constexpr uint32_t kMaxMaterials = 16384;
+    static constexpr uint32_t kMaxTextures = 4096;
+    static constexpr uint32_t kMaterialBinding = 0;
+    static constexpr uint32_t kTextureBinding = 1;
+    static constexpr uint32_t kFallbackSlot = 0;
+
+    void init(VulkanEngine* engine);
+    void destroy();
+
+    /** @brief Recycles the slots released at least FRAME_OVERLAP frames ago.
+     * Call once per frame after waiting on the frame's fence.
+     * */
+    void begin_frame(uint64_t frameNumber);
+
+    /** @return index into the texture array. **/
+    uint32_t acquire_texture(VkImageView view, VkSampler sampler);
+    void release_texture(uint32_t index);
+
+    /** @return index into the material buffer. **/
+    uint32_t add_material(
+            const GLTFMetallic_Roughness::MaterialConstants& constants);
+    void remove_material(uint32_t index);
+
+    [[nodiscard]] VkDescriptorSetLayout layout() const {
+        return _layout;
+    }
+
+    [[nodiscard]] VkDescriptorSet set() const {
+        return _set;
+    }
+
+private:
+    // free list whose released slots wait a few frames before reuse
+    struct SlotAllocator {
+        uint32_t capacity = 0;
+        uint32_t next = 0;
+        std::vector<uint32_t> free;
+        std::vector<std::pair<uint64_t, uint32_t>> retired;
+
+        uint32_t allocate();
+        void retire(uint32_t slot, uint64_t frame);
+        void recycle(uint64_t frameNumber);
+    };
+
+    struct TextureSlot {
+        VkImageView view = VK_NULL_HANDLE;
+        VkSampler sampler = VK_NULL_HANDLE;
+        uint32_t refCount = 0;
+    };
+
+    VulkanEngine* _engine = nullptr;
+    VkDescriptorPool _pool = VK_NULL_HANDLE;
+    VkDescriptorSetLayout _layout = VK_NULL_HANDLE;
+    VkDescriptorSet _set = VK_NULL_HANDLE;
+
+    std::unique_ptr<VulkanBuffer> _materials;
+    GLTFMetallic_Roughness::MaterialConstants* _materialData = nullptr;
+
+    SlotAllocator _materialSlots;
+    SlotAllocator _textureSlots;
+    std::vector<TextureSlot> _textures;
+    std::map<std::pair<VkImageView, VkSampler>, uint32_t> _textureLookup;
+    uint64_t _frameNumber = 0;
+};
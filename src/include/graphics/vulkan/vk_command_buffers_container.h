@@ -6,26 +6,46 @@
 #include <vulkan/vulkan_core.h>
 
 #include "vk_descriptors.h"
+#include "vk_frame_arena.h"
 #include "vk_smart_wrappers.h"
 
 constexpr unsigned int FRAME_OVERLAP = 2;
+// initial capacity of each frame arena, one that overflows is regrown
+constexpr VkDeviceSize FRAME_ARENA_SIZE = 8 * 1024 * 1024;
+
+// command buffers recorded by one JobSystem slot, a pool is only ever used
+// by one thread at a time
+struct SecondaryCommandPool {
+    std::unique_ptr<VulkanCommandPool> pool;
+    std::vector<VkCommandBuffer> buffers;
+    // buffers handed out since the pool was last reset
+    uint32_t used = 0;
+};
 
 struct FrameData {
     std::unique_ptr<VulkanCommandPool> _commandPool;
     VkCommandBuffer _mainCommandBuffer;
 
+    // one per JobSystem slot, for draws recorded in parallel
+    std::vector<SecondaryCommandPool> _secondaryPools;
+
     std::unique_ptr<VulkanSemaphore> _swapchainSemaphore, _renderSemaphore;
     std::unique_ptr<VulkanFence> _renderFence;
 
     DescriptorAllocatorGrowable _frameDescriptors;
     std::vector<std::unique_ptr<VulkanBuffer>> _frameBuffers; // For per-frame temporary buffers
+
+    // transient uniform and storage data, _sceneDescriptor points into it
+    // and is bound with a dynamic offset
+    FrameArena _arena;
+    VkDescriptorSet _sceneDescriptor;
 };
 
 class VulkanEngine;
 
 class CommandBuffersContainer {
 public:
-    CommandBuffersContainer();
+    CommandBuffersContainer() = default;
     ~CommandBuffersContainer() = default;
 
     // Frame management
@@ -35,11 +55,6 @@ public:
         return _frames[frameNumber % FRAME_OVERLAP];
     }
 
-    // Immediate command buffer members
-    std::unique_ptr<VulkanFence> _immFence;
-    VkCommandBuffer _immCommandBuffer;
-    std::unique_ptr<VulkanCommandPool> _immCommandPool;
-
     // Initialization
     void init_sync_structures(VulkanEngine* vk_engine);
 
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+#include <vector>
+
+struct RenderObject;
+
+/** @brief The six clip planes of a view-projection matrix.
+ *
+ * @details Planes are normalized and point inwards, so a point p is inside a
+ * plane when dot(plane.xyz, p) + plane.w >= 0.
+ * */
+struct Frustum {
+    std::array<glm::vec4, 6> planes;
+
+    static Frustum from_matrix(const glm::mat4& viewproj);
+};
+
+/** @brief Finds the render objects whose bounds are inside the view.
+ *
+ * @details Object bounds are brought to world space as spheres and stored
+ * structure-of-arrays, then tested against the frustum 8 objects at a time
+ * with AVX, or 4 at a time with SSE when AVX is not enabled for the build.
+ * The scratch arrays are kept between calls to avoid per-frame allocations.
+ * */
+class FrustumCuller {
+public:
+    /** @brief Appends the indices of the visible objects in [begin, end),
+     * leaving objects untouched. Objects without a material are skipped.
+     * Separate cullers may work on disjoint ranges of the same objects
+     * concurrently.
+     * @return number of objects with a material that were culled.
+     * */
+    std::size_t cull(const Frustum& frustum,
+                     const std::vector<RenderObject>& objects,
+                     std::size_t begin, std::size_t end,
+                     std::vector<uint32_t>& visible);
+
+private:
+    void load_spheres(const std::vector<RenderObject>& objects,
+                      std::size_t begin, std::size_t end);
+    void test_spheres(const Frustum& frustum, std::size_t count);
+
+    std::vector<float> _centerX;
+    std::vector<float> _centerY;
+    std::vector<float> _centerZ;
+    std::vector<float> _radius;
+    std::vector<uint8_t> _visible;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "vk_smart_wrappers.h"
+
+/** @brief Holds GPU resources until the last frame that used them is done.
+ *
+ * @details Every resource is tagged with the number of the last frame that
+ * may reference it. Resources sharing a tag go into one bucket, and buckets
+ * stay ordered by frame, so collect() only pops from the front. The render
+ * loop calls collect() right after waiting on a frame's fence with the
+ * newest frame known to be complete, which frees memory without ever
+ * stalling the device.
+ * */
+class DeferredDeletionQueue {
+public:
+    void push(uint64_t lastUsedFrame, std::unique_ptr<VulkanBuffer> buffer);
+    void push(uint64_t lastUsedFrame, std::unique_ptr<VulkanImage> image);
+    void push(uint64_t lastUsedFrame, VkSampler sampler);
+    void push(uint64_t lastUsedFrame, VkDescriptorPool pool);
+
+    /** @brief Destroys everything last used in or before completedFrame. **/
+    void collect(VkDevice device, uint64_t completedFrame);
+
+    /** @brief Destroys everything. The device must be idle. **/
+    void flush(VkDevice device);
+
+    [[nodiscard]] size_t pending_frames() const {
+        return _buckets.size();
+    }
+
+private:
+    struct Bucket {
+        uint64_t frame = 0;
+        std::vector<std::unique_ptr<VulkanBuffer>> buffers;
+        std::vector<std::unique_ptr<VulkanImage>> images;
+        std::vector<VkSampler> samplers;
+        std::vector<VkDescriptorPool> descriptorPools;
+    };
+
+    Bucket& bucket(uint64_t frame);
+    static void destroy(VkDevice device, Bucket& bucket);
+
+    std::deque<Bucket> _buckets;
+};
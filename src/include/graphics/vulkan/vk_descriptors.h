@@ -10,7 +10,8 @@
 struct DescriptorLayoutBuilder {
     std::vector<VkDescriptorSetLayoutBinding> bindings;
 
-    void add_binding(uint32_t binding, VkDescriptorType type);
+    void add_binding(uint32_t binding, VkDescriptorType type,
+                     uint32_t count = 1);
     void clear();
     VkDescriptorSetLayout build(VkDevice device,
                                 VkShaderStageFlags shaderStages,
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <vector>
+
+#include "vk_culling.h"
+
+class JobSystem;
+struct RenderObject;
+
+/** @brief Culls the retained render objects and assigns the sort keys of
+ * the visible ones across the threads of a JobSystem.
+ *
+ * @details The objects are cut into fixed chunks of kChunkSize. Every thread
+ * culls with its own FrustumCuller and every chunk collects its visible
+ * indices in its own list, so the workers share nothing but the read-only
+ * objects and the sort keys of the objects they own. The chunk lists are then
+ * placed after one another from a prefix sum of their sizes and copied
+ * concurrently, which gives the same visible list, in index order, whatever
+ * the number of threads.
+ * */
+class DrawListBuilder {
+public:
+    static constexpr std::size_t kChunkSize = 4096;
+
+    /** @brief Replaces visible with the indices of the objects inside the
+     * view, ready for DrawSorter::sort_assigned(). Objects without a material
+     * are skipped.
+     * @param jobs runs everything on the calling thread when null.
+     * @return number of objects with a material that were culled.
+     * */
+    std::size_t build(JobSystem* jobs, const glm::mat4& viewproj,
+                      const glm::mat4& view, float farPlane,
+                      std::vector<RenderObject>& objects,
+                      std::vector<uint32_t>& visible);
+
+private:
+    struct Chunk {
+        std::vector<uint32_t> visible;
+        std::size_t culled;
+        // where visible starts in the merged list
+        std::size_t offset;
+    };
+
+    std::vector<FrustumCuller> _cullers;
+    std::vector<Chunk> _chunks;
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <vector>
+
+struct RenderObject;
+
+/** @brief Packs the state a draw needs into a single sortable integer.
+ *
+ * @details From the most significant bit: material pass (2 bits), pipeline
+ * (10), bindless material index (16), surface (16) and quantized view depth
+ * (20), so that sorting groups draws by the state that is most expensive to
+ * change, keeps copies of a surface adjacent for instancing and orders each
+ * group front to back. Pipelines and surfaces (index buffer plus first index)
+ * are reduced to hashes; a collision only costs a redundant bind or a split
+ * instance batch, the recorder still compares the real values.
+ *
+ * @param viewDepth distance along the view direction, clamped to [0, far].
+ * */
+uint64_t make_sort_key(const RenderObject& object, float viewDepth,
+                       float farPlane);
+
+/** @brief Stores the sort key of object, measuring its depth at the center
+ * of its bounds.
+ * */
+uint64_t assign_sort_key(const glm::mat4& view, float farPlane,
+                         RenderObject& object);
+
+/** @brief Whether two objects differ only in their world matrix, so that
+ * they can be recorded as instances of a single draw.
+ * */
+bool can_instance(const RenderObject& a, const RenderObject& b);
+
+/** @brief Orders render objects by their sort keys.
+ *
+ * @details Keys are sorted with an LSD radix sort over (key, index) pairs, 8
+ * bits per pass. Passes where every key shares the same byte are skipped. The
+ * objects themselves are not moved, the result is the order in which to
+ * record them.
+ * */
+class DrawSorter {
+public:
+    /** @brief Sorts only the objects listed in subset, whose keys were
+     * already assigned, e.g. by the workers that culled them. order receives
+     * indices into objects.
+     * */
+    void sort_assigned(const std::vector<RenderObject>& objects,
+                       const std::vector<uint32_t>& subset,
+                       std::vector<uint32_t>& order);
+
+private:
+    struct Entry {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    void radix_sort(std::vector<uint32_t>& order);
+
+    std::vector<Entry> _entries;
+    std::vector<Entry> _scratch;
+};
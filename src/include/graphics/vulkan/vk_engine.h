@@ -2,7 +2,9 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <glm/ext/matrix_double4x4.hpp>
 #include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_double3.hpp>
 #include <glm/ext/vector_float4.hpp>
 #include <memory>
 #include <span>
@@ -13,6 +15,15 @@
 #include <vulkan/vk_platform.h>
 #include <vulkan/vulkan_core.h>
 
+#include "core/JobSystem.h"
+#include "core/SlotMap.h"
+#include "vk_asset_cache.h"
+#include "vk_bindless.h"
+#include "vk_deletion_queue.h"
+#include "vk_draw_list.h"
+#include "vk_draw_sort.h"
+#include "vk_gpu_driven.h"
+#include "vk_upload.h"
 #include "vk_descriptors.h"
 #include "vk_types.h"
 #include "vk_smart_wrappers.h"
@@ -43,8 +54,6 @@ struct MeshNode : public ENode {
     MeshNode() = default;
 
     std::shared_ptr<MeshAsset> mesh;
-
-    void Draw(const glm::mat4& topMatrix, DrawContext& ctx) override;
 };
 
 struct RenderObject {
@@ -53,13 +62,58 @@ struct RenderObject {
     VkBuffer indexBuffer;
 
     MaterialInstance* material;
+    Bounds bounds;
 
     glm::mat4 transform;
     VkDeviceAddress vertexBufferAddress;
+
+    uint64_t sortKey;
 };
 
 struct DrawContext {
     std::vector<RenderObject> OpaqueSurfaces;
+    // indices into OpaqueSurfaces in recording order
+    std::vector<uint32_t> OpaqueOrder;
+};
+
+// objects of the main draw context, kept across frames, hold one range of
+// render proxies per mesh instance; a proxy without a material belongs to an
+// unregistered instance and waits for compaction
+struct RenderProxyRange {
+    uint32_t first;
+    uint32_t count;
+};
+
+// a registered mesh instance, the file itself is shared through the asset cache
+struct MeshInstance {
+    // world matrix relative to VulkanEngine::renderOrigin
+    glm::mat4 transform;
+    // authoritative translation, transform's is rebuilt from it
+    glm::dvec3 worldPosition;
+    std::shared_ptr<LoadedGLTF> asset;
+    // its render objects in the main draw context
+    RenderProxyRange proxies;
+    // world matrix of every node of the file, indexed like its render list,
+    // once the nodes are driven one by one; empty while the file moves as a
+    // whole
+    std::vector<glm::dmat4> nodeWorlds;
+};
+
+using MeshHandle = SlotHandle;
+
+// per frame counters, shown in the debug ui
+struct EngineStats {
+    uint32_t objectCount;
+    uint32_t culledObjectCount;
+    uint32_t drawCount;  // after instancing
+    float sceneUpdateTime;  // ms
+
+    uint32_t pipelineBinds;
+    uint32_t pipelineBindsSkipped;
+    uint32_t descriptorSetBinds;
+    uint32_t descriptorSetBindsSkipped;
+    uint32_t indexBufferBinds;
+    uint32_t indexBufferBindsSkipped;
 };
 
 class VulkanEngine {
@@ -70,25 +124,73 @@ public:
     CommandBuffers command_buffers;
     CommandBuffersContainer command_buffers_container;
 
-    int64_t registerMesh(const std::string& filePath);
+    MeshHandle registerMesh(const std::string& filePath);
+
+    /** @brief Registers handles.size() instances of one file with identity
+     * transforms, loading and referencing the file only once.
+     * */
+    void registerMeshes(const std::string& filePath,
+                        std::span<MeshHandle> handles);
 
-    void unregisterMesh(int64_t id);
+    void unregisterMesh(MeshHandle handle);
 
-    void setMeshTransform(int64_t id, glm::mat4 mat);
+    void setMeshTransform(MeshHandle handle, glm::mat4 mat);
 
-    std::unordered_map<int64_t, std::shared_ptr<LoadedGLTF>> meshes;
+    /** @brief Sets a world matrix whose translation keeps double precision
+     * until it is made relative to the render origin.
+     * */
+    void setMeshTransform(MeshHandle handle, const glm::dmat4& mat);
 
-    std::unordered_map<int64_t, glm::mat4> transforms;
+    /** @brief Sets mats[i] as the world matrix of handles[i], writing
+     * straight into the dense instance array. Stale handles are skipped.
+     * */
+    void setMeshTransforms(std::span<const MeshHandle> handles,
+                           std::span<const glm::mat4> mats);
+
+    /** @brief Sets worlds[i] as the world matrix of node nodes[i] of an
+     * instance, an index into its file's GLTFRenderList.
+     * @details The first call detaches the nodes from the instance, which
+     * from then on follows its nodes only and ignores setMeshTransform().
+     * Nodes that are never set keep the world matrix they had then.
+     * */
+    void setMeshNodeTransforms(MeshHandle handle,
+                               std::span<const uint32_t> nodes,
+                               std::span<const glm::dmat4> worlds);
+
+    SlotMap<MeshInstance> meshes;
 
     std::unordered_map<std::string, std::shared_ptr<LoadedGLTF>> loadedScenes;
 
+    GLTFAssetCache assetCache;
+
     Camera* mainCamera;
 
     DrawContext mainDrawContext;
+    // culls the main draw context and assigns its sort keys on every
+    // hardware thread
+    JobSystem jobs;
+    DrawListBuilder drawListBuilder;
+    DrawSorter drawSorter;
+    GPUDrivenRenderer gpuDrivenRenderer;
+    // cull and build draws with compute instead of the cpu loop
+    bool gpuDrivenRendering{false};
+    // render around the camera instead of the world origin, which keeps
+    // float precision for scenes spanning huge distances
+    bool largeWorldRendering{false};
+    // world position subtracted from every instance and from the camera
+    glm::dvec3 renderOrigin{0.0};
+    // how far the camera may get from renderOrigin before it is moved; a
+    // rebase rewrites every instance, so it must not follow the camera each
+    // frame, while floats keep sub millimeter precision at this distance
+    static constexpr double kRenderOriginRebaseDistance = 1024.0;
+    EngineStats stats{};
     std::unordered_map<std::string, std::shared_ptr<ENode>> loadedNodes;
 
     void update_scene();
 
+    // rebuilds the relative translation of every mesh instance
+    void rebase_mesh_instances();
+
     FrameData& get_current_frame() {
         return command_buffers_container.get_current_frame(_frameNumber);
     };
@@ -96,6 +198,13 @@ public:
     VkQueue _graphicsQueue;
     uint32_t _graphicsQueueFamily;
 
+    // dedicated transfer queue if the device has one, the graphics queue
+    // otherwise
+    VkQueue _transferQueue;
+    uint32_t _transferQueueFamily;
+
+    UploadManager uploads;
+
     bool _isInitialized{false};
     unsigned int _frameNumber{0};
     bool stop_rendering{false};
@@ -161,7 +270,7 @@ public:
                                 bool mipmapped = false) const;
     AllocatedImage create_image(const void* data, VkExtent3D size,
                                 VkFormat format, VkImageUsageFlags usage,
-                                bool mipmapped = false) const;
+                                bool mipmapped = false);
     void destroy_image(const AllocatedImage& img) const;
 
     std::unique_ptr<VulkanImage> _whiteImage;
@@ -177,12 +286,30 @@ public:
     MaterialInstance defaultData;
     GLTFMetallic_Roughness metalRoughMaterial;
 
+    // all materials and textures, bound once per frame as set 1
+    BindlessRegistry bindless;
+
     AllocatedBuffer create_buffer(size_t allocSize, VkBufferUsageFlags usage,
                                   VmaMemoryUsage memoryUsage) const;
 
+    // destroy once every frame recorded so far has finished on the gpu
+    void defer_destroy(const AllocatedBuffer& buffer);
+    void defer_destroy(const AllocatedImage& image);
+    void defer_destroy(VkSampler sampler);
+    void defer_destroy(const GPUMeshBuffers& meshBuffers);
+
+    DeferredDeletionQueue deletionQueue;
+
+    // transient uniform/storage memory, valid until this frame slot is reused
+    FrameArena::Allocation allocate_frame_data(VkDeviceSize size);
+
+    // points the frame's scene descriptor at its current arena buffer
+    void write_scene_descriptor(FrameData& frame) const;
+    // replaces an arena that overflowed during the frame's last use
+    void grow_frame_arena(FrameData& frame);
+
 private:
     // Smart pointer collections for automatic cleanup
-    std::vector<std::unique_ptr<VulkanBuffer>> _managedBuffers;
     std::vector<std::unique_ptr<VulkanImage>> _managedImages;
 
     static VKAPI_ATTR VkBool32 VKAPI_CALL
@@ -206,7 +333,49 @@ private:
 
     void draw_imgui(VkCommandBuffer cmd, VkImageView targetImageView) const;
 
+    // render proxies are created, patched and dropped with their instance
+    void add_render_proxies(MeshInstance& mesh);
+    void patch_render_proxies(const MeshInstance& mesh);
+    void remove_render_proxies(const MeshInstance& mesh);
+    void compact_render_proxies();
+
+    uint32_t _deadRenderProxies{0};
+    // the visible set and its order are reused while neither the proxies nor
+    // the camera change
+    bool _renderProxiesChanged{true};
+    glm::mat4 _cullViewproj{0.f};
+    std::vector<uint32_t> _visibleProxies;
+
+    // a run of consecutive entries of OpaqueOrder drawn as instances of one
+    // draw
+    struct DrawBatch {
+        uint32_t first;
+        uint32_t count;
+    };
+
+    // batches per secondary command buffer, below two of them the draws are
+    // recorded inline
+    static constexpr std::size_t kSecondaryBatchCount = 256;
+
+    std::vector<DrawBatch> _opaqueBatches;
+    VkDeviceAddress _opaqueInstanceBuffer{0};
+    std::vector<VkCommandBuffer> _opaqueSecondaries;
+    std::vector<EngineStats> _opaqueSecondaryStats;
+
     void draw_geometry(VkCommandBuffer cmd);
+    // writes the instance transforms and groups the sorted draws into batches
+    void prepare_opaque_batches();
+    // only touches cmd and counters, so disjoint ranges can be recorded from
+    // several threads
+    void record_opaque_batches(VkCommandBuffer cmd,
+                               VkDescriptorSet globalDescriptor,
+                               uint32_t sceneDataOffset, std::size_t begin,
+                               std::size_t end, EngineStats& counters) const;
+    // records the batches into secondary command buffers on every thread,
+    // _opaqueSecondaries receives them in draw order
+    void record_opaque_secondaries(VkDescriptorSet globalDescriptor,
+                                   uint32_t sceneDataOffset);
+    VkCommandBuffer acquire_secondary_command_buffer(unsigned slot);
 
     void destroy_buffer(const AllocatedBuffer& buffer) const;
 
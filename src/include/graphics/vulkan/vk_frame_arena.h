@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan_core.h>
+
+#include "vk_smart_wrappers.h"
+
+/** @brief Per-frame linear allocator for transient GPU data.
+ *
+ * @details Owns one persistently mapped host visible buffer usable as uniform,
+ * storage and device address memory. Allocations bump a head pointer and are
+ * all released at once by reset(), which the owning frame calls after its
+ * fence has signaled. Because everything lives in the same VkBuffer, a
+ * descriptor written once can address any allocation through a dynamic
+ * offset.
+ * */
+class FrameArena {
+public:
+    struct Allocation {
+        VkBuffer buffer;
+        VkDeviceSize offset;
+        void* data;
+        VkDeviceAddress address;  // already includes offset
+    };
+
+    /** @param alignment alignment of every allocation, at least the device's
+     * uniform and storage buffer offset alignment.
+     * */
+    void init(VmaAllocator allocator, VkDevice device, VkDeviceSize capacity,
+              VkDeviceSize alignment);
+    void destroy();
+
+    /** @brief Replaces the buffer with one of the given capacity.
+     * @return the previous buffer, which in-flight frames may still read.
+     * */
+    std::unique_ptr<VulkanBuffer> grow(VmaAllocator allocator, VkDevice device,
+                                       VkDeviceSize capacity);
+
+    void reset() {
+        _head = 0;
+        _overflow = 0;
+    }
+
+    /** @return std::nullopt if the arena does not have size bytes left. **/
+    std::optional<Allocation> allocate(VkDeviceSize size);
+
+    /** @brief Bytes requested since the last reset that did not fit. **/
+    [[nodiscard]] VkDeviceSize overflow() const {
+        return _overflow;
+    }
+
+    [[nodiscard]] VkBuffer buffer() const {
+        return _buffer ? _buffer->buffer() : VK_NULL_HANDLE;
+    }
+
+    [[nodiscard]] VkDeviceSize used() const {
+        return _head;
+    }
+
+    [[nodiscard]] VkDeviceSize capacity() const {
+        return _capacity;
+    }
+
+private:
+    std::unique_ptr<VulkanBuffer> _buffer;
+    std::byte* _data = nullptr;
+    VkDeviceAddress _address = 0;
+    VkDeviceSize _capacity = 0;
+    VkDeviceSize _alignment = 1;
+    VkDeviceSize _head = 0;
+    VkDeviceSize _overflow = 0;
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+#include <memory>
+#include <vector>
+
+#include "ComputePipeline.h"
+#include "vk_smart_wrappers.h"
+#include "vk_types.h"
+
+class VulkanEngine;
+
+// one culled surface, laid out as CullObject in cull.comp
+struct GPUCullObject {
+    glm::mat4 nodeMatrix;
+    glm::vec4 sphere;  // object space center, radius in w
+    uint32_t transformIndex;
+    uint32_t batchIndex;
+    uint32_t pad[2];
+};
+
+// one indirect draw slot, laid out as CullBatch in cull.comp
+struct GPUCullBatch {
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    uint32_t instanceBase;
+    uint32_t groupIndex;
+    uint32_t firstDraw;
+    uint32_t pad[3];
+};
+
+// per frame inputs of cull.comp, laid out as CullParams
+struct GPUCullParams {
+    glm::vec4 planes[6];
+    uint32_t objectCount;
+    uint32_t batchCount;
+    uint32_t pad[2];
+    VkDeviceAddress objects;
+    VkDeviceAddress batches;
+    VkDeviceAddress transforms;
+    VkDeviceAddress batchCounts;
+    VkDeviceAddress groupCounts;
+    VkDeviceAddress instances;
+    VkDeviceAddress draws;
+};
+
+struct GPUCullPushConstants {
+    VkDeviceAddress params;
+    uint32_t pass;
+    uint32_t pad;
+};
+
+/** @brief Culls and draws the registered meshes without a per-object CPU
+ * loop.
+ *
+ * @details Every surface of every mesh instance is kept in a persistent
+ * object table that is only rebuilt when instances are added or removed.
+ * Surfaces that share index range and material form a batch, and batches
+ * that share pipeline, material and buffers form a group.
+ *
+ * Each frame cull.comp tests the objects against the frustum, appends the
+ * world matrix of every survivor to its batch's instance range, and then
+ * compacts the non-empty batches of each group into that group's region of
+ * the indirect buffer. draw() records one vkCmdDrawIndexedIndirectCount per
+ * group, with the draw count read from the GPU.
+ * */
+class GPUDrivenRenderer {
+public:
+    void init(VulkanEngine* engine);
+    void destroy();
+
+    /** @brief Schedules a rebuild of the object table before the next cull.
+     **/
+    void mark_dirty() {
+        _dirty = true;
+    }
+
+    /** @brief Records the culling dispatches. Must be called outside of
+     * rendering, before draw().
+     * */
+    void cull(VkCommandBuffer cmd, const glm::mat4& viewproj);
+
+    /** @brief Records the indirect draws inside the current rendering. **/
+    void draw(VkCommandBuffer cmd, VkDescriptorSet globalDescriptor,
+              uint32_t sceneDataOffset);
+
+    [[nodiscard]] uint32_t object_count() const {
+        return _objectCount;
+    }
+
+    [[nodiscard]] uint32_t group_count() const {
+        return static_cast<uint32_t>(_groups.size());
+    }
+
+private:
+    struct DrawGroup {
+        MaterialInstance* material;
+        VkBuffer indexBuffer;
+        VkDeviceAddress vertexBuffer;
+        uint32_t firstDraw;
+        uint32_t batchCount;
+    };
+
+    void rebuild();
+
+    std::unique_ptr<VulkanBuffer> create_table(size_t size,
+                                               VkBufferUsageFlags usage,
+                                               VmaMemoryUsage memoryUsage,
+                                               VkDeviceAddress& address) const;
+
+    VulkanEngine* _engine = nullptr;
+    ComputePipeline _cullPipeline;
+
+    std::vector<DrawGroup> _groups;
+    uint32_t _objectCount = 0;
+    uint32_t _batchCount = 0;
+    bool _dirty = true;
+
+    std::unique_ptr<VulkanBuffer> _objects;
+    std::unique_ptr<VulkanBuffer> _batches;
+    std::unique_ptr<VulkanBuffer> _batchCounts;
+    std::unique_ptr<VulkanBuffer> _groupCounts;
+    std::unique_ptr<VulkanBuffer> _instances;
+    std::unique_ptr<VulkanBuffer> _draws;
+
+    VkDeviceAddress _objectsAddress = 0;
+    VkDeviceAddress _batchesAddress = 0;
+    VkDeviceAddress _batchCountsAddress = 0;
+    VkDeviceAddress _groupCountsAddress = 0;
+    VkDeviceAddress _instancesAddress = 0;
+    VkDeviceAddress _drawsAddress = 0;
+};
@@ -24,6 +24,7 @@ struct GLTFMaterial {
 struct GeoSurface {
     uint32_t startIndex;
     uint32_t count;
+    Bounds bounds;
     std::shared_ptr<GLTFMaterial> material;
 };
 
@@ -37,6 +38,32 @@ struct MeshAsset {
 std::optional<std::vector<std::shared_ptr<MeshAsset>>> loadGltfMeshes(
         VulkanEngine* engine, const std::filesystem::path& filePath);
 
+/** @brief Nodes and surfaces of a glTF file flattened into parallel arrays.
+ *
+ * @details Nodes are stored in pre-order, so a parent always comes before
+ * its children and world matrices are composed in one forward pass.
+ * Surfaces are grouped by node in the same order, so drawing is a linear
+ * walk that multiplies each node matrix once.
+ * */
+struct GLTFRenderList {
+    static constexpr uint32_t kNoParent = UINT32_MAX;
+
+    // per node
+    std::vector<ENode*> nodes;
+    std::vector<glm::mat4> localTransforms;
+    std::vector<glm::mat4> worldTransforms;
+    std::vector<uint32_t> parents;
+
+    // per surface
+    std::vector<uint32_t> surfaceNodes;
+    std::vector<uint32_t> firstIndices;
+    std::vector<uint32_t> indexCounts;
+    std::vector<Bounds> bounds;
+    std::vector<MaterialInstance*> materials;
+    std::vector<VkBuffer> indexBuffers;
+    std::vector<VkDeviceAddress> vertexBufferAddresses;
+};
+
 struct LoadedGLTF final : public IRenderable {
     LoadedGLTF() = default;
 
@@ -46,17 +73,27 @@ struct LoadedGLTF final : public IRenderable {
     std::unordered_map<std::string, AllocatedImage> images;
     std::unordered_map<std::string, std::shared_ptr<GLTFMaterial>> materials;
 
+    // every mesh in file order; meshes above is keyed by name and keeps only
+    // the last of meshes sharing one, unnamed meshes included
+    std::vector<std::shared_ptr<MeshAsset>> meshList;
+
     // nodes that dont have a parent, for iterating through the file in tree
     // order
     std::vector<std::shared_ptr<ENode>> topNodes;
 
     std::vector<VkSampler> samplers;
 
-    DescriptorAllocatorGrowable descriptorPool;
+    // what Draw() walks, built once the node tree is complete
+    GLTFRenderList renderList;
 
-    AllocatedBuffer materialDataBuffer;
+    // slots held in the engine's bindless registry
+    std::vector<uint32_t> bindlessMaterials;
+    std::vector<uint32_t> bindlessTextures;
 
-    VulkanEngine* creator;
+    VulkanEngine* creator = nullptr;
+
+    // path the file was loaded from, also its key in the asset cache
+    std::string sourcePath;
 
     ~LoadedGLTF() {
         clearAll();
@@ -64,6 +101,17 @@ struct LoadedGLTF final : public IRenderable {
 
     void Draw(const glm::mat4& topMatrix, DrawContext& ctx);
 
+    /** @brief Flattens topNodes into renderList. **/
+    void build_render_list();
+
+    /** @brief Recomputes the world matrices in one pass over the flattened
+     * nodes and copies them back to the nodes.
+     * @details The file is shared by every instance through the asset cache,
+     * so its node matrices are fixed once loaded; instances are moved as a
+     * whole through VulkanEngine::setMeshTransform().
+     * */
+    void refresh_transforms();
+
 private:
     void clearAll();
 };
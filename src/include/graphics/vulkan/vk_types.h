@@ -47,11 +47,22 @@ struct Vertex {
     glm::vec4 color;
 };
 
+// object space bounds of a surface, sphere and box share the origin
+struct Bounds {
+    glm::vec3 origin;
+    float sphereRadius;
+    glm::vec3 extents;
+};
+
+// value of the upload timeline semaphore once a copy has landed, 0 for none
+using UploadTicket = uint64_t;
+
 // holds the resources needed for a mesh
 struct GPUMeshBuffers {
     AllocatedBuffer indexBuffer;
     AllocatedBuffer vertexBuffer;
     VkDeviceAddress vertexBufferAddress;
+    UploadTicket uploadTicket;
 };
 
 // push constants for our mesh object draws
@@ -60,6 +71,29 @@ struct GPUDrawPushConstants {
     VkDeviceAddress vertexBuffer;
 };
 
+// world matrix of an instance as sent to the gpu: the first three rows of
+// the affine matrix, its last row is always (0, 0, 0, 1). Shaders read it as
+// a mat3x4 and transform with vector * matrix.
+struct GPUInstanceTransform {
+    glm::vec4 rows[3];
+
+    static GPUInstanceTransform from_matrix(const glm::mat4& m) {
+        return {{glm::vec4(m[0][0], m[1][0], m[2][0], m[3][0]),
+                 glm::vec4(m[0][1], m[1][1], m[2][1], m[3][1]),
+                 glm::vec4(m[0][2], m[1][2], m[2][2], m[3][2])}};
+    }
+};
+
+// push constants for instanced draws, the world matrix of each instance is
+// read from instanceBuffer at gl_InstanceIndex and the material from the
+// bindless material buffer at materialIndex
+struct GPUInstancedDrawPushConstants {
+    VkDeviceAddress vertexBuffer;
+    VkDeviceAddress instanceBuffer;
+    uint32_t materialIndex;
+    uint32_t pad;
+};
+
 enum class MaterialPass : uint8_t { MainColor, Transparent, Other };
 
 struct MaterialPipeline {
@@ -69,7 +103,7 @@ struct MaterialPipeline {
 
 struct MaterialInstance {
     MaterialPipeline* pipeline;
-    VkDescriptorSet materialSet;
+    uint32_t materialIndex;  // slot in the bindless material buffer
     MaterialPass passType;
 };
 
@@ -96,7 +130,7 @@ struct ENode : public IRenderable {
 
     void refreshTransform(const glm::mat4& parentMatrix) {
         worldTransform = parentMatrix * localTransform;
-        for (auto c : children) {
+        for (const auto& c : children) {
             c->refreshTransform(worldTransform);
         }
     }
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "vk_smart_wrappers.h"
+#include "vk_types.h"
+
+class VulkanEngine;
+
+/** @brief Batches buffer and image uploads onto a transfer queue.
+ *
+ * @details Copies are recorded into an open batch and submitted together by
+ * submit(), normally once per frame. Each batch signals the next value of a
+ * timeline semaphore, which is the UploadTicket returned for every copy it
+ * contains. Nothing here blocks the CPU unless wait() is called.
+ *
+ * The render loop calls acquire() while recording a frame. It returns the
+ * ticket the frame has to wait on, or 0 if no upload finished since the last
+ * frame, so only the first frame that can see a new resource waits for it.
+ * When the transfer queue belongs to another family, acquire() also records
+ * the queue family ownership acquire barriers matching the release barriers
+ * recorded on the transfer queue.
+ *
+ * Copies are staged back to back in pages of kStagingPageSize bytes, so a
+ * batch usually owns a single staging buffer; a copy larger than a page gets
+ * a page of its own. Staging pages and command buffers of a batch are
+ * released by collect() once its ticket has been reached, and a few full
+ * size pages are kept for the next batches. Destination resources must
+ * outlive the batch that writes them.
+ * */
+class UploadManager {
+public:
+    void init(VulkanEngine* engine, VkQueue queue, uint32_t queueFamily);
+    void destroy();
+
+    /** @brief Records a copy of size bytes from data into dst. **/
+    UploadTicket upload_buffer(VkBuffer dst, VkDeviceSize dstOffset,
+                               const void* data, VkDeviceSize size);
+
+    /** @brief Records a copy of tightly packed texels into mip 0 of image
+     * and leaves it in SHADER_READ_ONLY_OPTIMAL.
+     * */
+    UploadTicket upload_image(const AllocatedImage& image, VkExtent3D extent,
+                              const void* data, VkDeviceSize size);
+
+    /** @brief Submits the open batch, if any.
+     * @return ticket of the last submitted batch.
+     * */
+    UploadTicket submit();
+
+    /** @brief Records pending ownership acquires into a graphics command
+     * buffer.
+     * @return ticket the submission of cmd must wait on, 0 for none.
+     * */
+    UploadTicket acquire(VkCommandBuffer cmd);
+
+    /** @brief Frees the staging memory of every completed batch. **/
+    void collect();
+
+    [[nodiscard]] bool is_complete(UploadTicket ticket) const;
+
+    /** @brief Blocks until ticket has been reached, submitting it first if it
+     * is still part of the open batch.
+     * */
+    void wait(UploadTicket ticket);
+
+    [[nodiscard]] VkSemaphore semaphore() const {
+        return _timeline;
+    }
+
+    [[nodiscard]] bool dedicated_queue_family() const {
+        return _queueFamily != _graphicsQueueFamily;
+    }
+
+    static constexpr VkDeviceSize kStagingPageSize = 8 * 1024 * 1024;
+
+private:
+    struct StagingPage {
+        std::unique_ptr<VulkanBuffer> buffer;
+        VkDeviceSize size = 0;
+    };
+
+    struct StagingRange {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+    };
+
+    struct Batch {
+        VkCommandBuffer cmd = VK_NULL_HANDLE;
+        UploadTicket ticket = 0;
+        // the last page is the one being filled
+        std::vector<StagingPage> staging;
+        VkDeviceSize stagingUsed = 0;
+        std::vector<VkBufferMemoryBarrier2> bufferAcquires;
+        std::vector<VkImageMemoryBarrier2> imageAcquires;
+    };
+
+    Batch& open_batch();
+    StagingRange stage(Batch& batch, const void* data, VkDeviceSize size);
+    StagingPage take_page(VkDeviceSize size);
+
+    VulkanEngine* _engine = nullptr;
+    VkQueue _queue = VK_NULL_HANDLE;
+    uint32_t _queueFamily = 0;
+    uint32_t _graphicsQueueFamily = 0;
+    VkCommandPool _pool = VK_NULL_HANDLE;
+    VkSemaphore _timeline = VK_NULL_HANDLE;
+
+    std::unique_ptr<Batch> _open;
+    std::vector<std::unique_ptr<Batch>> _inFlight;
+    // full size pages of completed batches, reused before allocating
+    std::vector<StagingPage> _freePages;
+
+    UploadTicket _nextTicket = 1;
+    UploadTicket _lastSubmitted = 0;
+    UploadTicket _lastAcquired = 0;
+
+    // acquire halves of the submitted ownership transfers, recorded by
+    // acquire()
+    std::vector<VkBufferMemoryBarrier2> _bufferAcquires;
+    std::vector<VkImageMemoryBarrier2> _imageAcquires;
+};
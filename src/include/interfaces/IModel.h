@@ -2,7 +2,9 @@
 
 #include <array>
 #include <cstdint>
+#include <glm/ext/matrix_float4x4.hpp>
 #include <memory>
+#include <span>
 #include <string>
 #include <string_view>
 
@@ -21,6 +23,13 @@
  */
 class IModel {
 public:
+    /*!
+     * \brief Identifies a mesh without going through its name.
+     *
+     * 0 never refers to a mesh.
+     */
+    using MeshHandle = std::uint64_t;
+
     /*!
      * \brief Virtual destructor for the interface.
      *
@@ -66,7 +75,45 @@ public:
      * This method sets the transformation matrix for the mesh identified by the
      * provided name.
      */
-    virtual void setMeshTransform(std::string name, glm::mat4x4 transform) = 0;
+    virtual void setMeshTransform(const std::string& name,
+                                  const glm::mat4x4& transform) = 0;
+
+    /*!
+     * \brief Creates handles.size() unnamed meshes at once.
+     *
+     * \param handles Receives the handle of every new mesh.
+     *
+     * The meshes share the default model and start with an identity
+     * transform. They live as long as the model.
+     */
+    virtual void createMeshes(std::span<MeshHandle> handles) = 0;
+
+    /*!
+     * \brief Retrieves the handle of a named mesh.
+     *
+     * \param name Name given to createMesh().
+     * \return The handle, or 0 if no mesh has this name.
+     *
+     * Meant to be called once, so that per frame updates can go through
+     * setMeshTransforms() without looking names up. The handle stays valid
+     * until the mesh is replaced by another createMesh() with the same name.
+     */
+    [[nodiscard]] virtual MeshHandle getMeshHandle(
+            const std::string& name) const = 0;
+
+    /*!
+     * \brief Sets the transformation matrices of many meshes at once.
+     *
+     * \param handles Meshes to update.
+     * \param transforms transforms[i] is applied to handles[i]; both spans
+     * have the same size.
+     *
+     * The matrices are written straight into the renderer's instance array
+     * with a single call for the whole batch. Named meshes keep the new
+     * transform, as if setMeshTransform() had been called.
+     */
+    virtual void setMeshTransforms(std::span<const MeshHandle> handles,
+                                   std::span<const glm::mat4> transforms) = 0;
 
     /*!
      * \brief Retrieves the camera instance.
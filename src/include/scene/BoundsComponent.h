@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Bvh.h"
+#include "glm/vec3.hpp"
+
+/** @brief A component that stores the box enclosing an entity, in the
+ * entity's own coordinates.
+ *
+ * @details Entities with both LocalBounds and a GlobalTransform get
+ * WorldBounds and are indexed in the SpatialIndex.
+ * @see BoundsSystem
+ * */
+struct LocalBounds {
+    glm::f64vec3 center = glm::f64vec3(0.0);
+
+    glm::f64vec3 extents = glm::f64vec3(0.5);
+};
+
+/** @brief A component that stores the world space box of an entity,
+ * recomputed whenever its GlobalTransform changes.
+ * @see BoundsSystem
+ * */
+struct WorldBounds {
+    Aabb bounds;
+
+    Bvh::Proxy proxy = Bvh::kNullProxy;
+};
+
+/** @brief Singleton holding the BVH over every WorldBounds, keyed by entity
+ * id, for gameplay queries.
+ *
+ * @details The renderer does not query it: its proxies are keyed by mesh
+ * handle rather than entity, and the main view is culled by testing every
+ * render proxy in DrawListBuilder. Entities without LocalBounds are not
+ * indexed either.
+ * @see BoundsSystem
+ * */
+struct SpatialIndex {
+    Bvh bvh;
+};
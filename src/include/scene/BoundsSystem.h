@@ -0,0 +1,34 @@
+#pragma once
+
+#include "BoundsComponent.h"
+#include "GlobalTransformComponent.h"
+#include "flecs.h"
+
+/** @brief The world space box enclosing a local box under a transform.
+ * @details Each world extent is the sum of the local extents weighted by
+ * the absolute values of the matrix, which is exact for boxes and avoids
+ * transforming the eight corners.
+ * */
+Aabb transformBounds(const glm::f64mat4 &matrix, const LocalBounds &local);
+
+/**
+ * @brief Sets up the BoundsSystem in the given world.
+ *
+ * @details
+ * The BoundsSystem keeps the WorldBounds of every entity with LocalBounds
+ * and a GlobalTransform, and the SpatialIndex singleton that indexes them.
+ *
+ * It runs in PreStore, after the transform propagation, over the entities
+ * listed in TransformChanges only: their boxes are recomputed and moved in
+ * the BVH, which is then refitted once, and rebuilt if its quality degraded.
+ * The system guarantees the following invariants after each update: <br>
+ * - Every entity with LocalBounds and a GlobalTransform has WorldBounds
+ * matching its current GlobalTransform. <br>
+ * - The SpatialIndex holds exactly the entities with WorldBounds, and can be
+ * queried until the next update.
+ *
+ * Render culling does not go through the index, see SpatialIndex.
+ *
+ * @param world The world to set up the system in.
+ * */
+void BoundsSystem(flecs::world &world);
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/ext/vector_double3.hpp>
+#include <glm/ext/vector_double4.hpp>
+#include <limits>
+#include <vector>
+
+/** @brief Axis aligned box in world space. **/
+struct Aabb {
+    glm::dvec3 min;
+    glm::dvec3 max;
+
+    [[nodiscard]] bool overlaps(const Aabb &other) const;
+    [[nodiscard]] double surfaceArea() const;
+
+    static Aabb merge(const Aabb &a, const Aabb &b);
+};
+
+/** @brief Dynamic bounding volume hierarchy over axis aligned boxes.
+ *
+ * @details Every box is a leaf identified by a proxy, which stays valid until
+ * the box is removed, rebuilds included. Each leaf carries a user id,
+ * typically a flecs entity id, which is what the queries return.
+ *
+ * Inserting picks the sibling that grows the tree the least and removing
+ * collapses the leaf's parent, both in O(depth). Moving a box with update()
+ * only rewrites the leaf; refit() then walks up from the moved leaves and
+ * stops as soon as an ancestor is left unchanged, so a frame costs time
+ * proportional to what moved. Since refitting never restructures the tree,
+ * its quality slowly degrades: the summed surface area of the internal
+ * nodes over the root's is tracked, and refit() rebuilds the whole tree with
+ * a binned surface area heuristic once it exceeds the value right after the
+ * last rebuild by kRebuildRatio, or once the number of boxes has doubled
+ * since.
+ * */
+class Bvh {
+public:
+    using Proxy = uint32_t;
+
+    static constexpr Proxy kNullProxy = std::numeric_limits<uint32_t>::max();
+
+    /** @brief Cost growth over the last rebuild that triggers a new one. **/
+    static constexpr double kRebuildRatio = 1.5;
+
+    /** @brief Adds a box and returns its proxy. **/
+    Proxy insert(uint64_t id, const Aabb &bounds);
+
+    /** @brief Removes a box, its proxy becomes invalid. **/
+    void remove(Proxy proxy);
+
+    /** @brief Moves a box. Ancestors are only fixed by the next refit(), and
+     * queries must not run in between.
+     * */
+    void update(Proxy proxy, const Aabb &bounds);
+
+    /** @brief Fixes the ancestors of every box moved since the last call,
+     * then rebuilds the tree if its quality degraded too much.
+     * @return whether the tree was rebuilt.
+     * */
+    bool refit();
+
+    /** @brief Rebuilds the tree top-down with a binned surface area
+     * heuristic, keeping every proxy.
+     * */
+    void rebuild();
+
+    /** @brief Summed surface area of the internal nodes over the root's; a
+     * lower value means cheaper queries.
+     * */
+    [[nodiscard]] double cost() const;
+
+    [[nodiscard]] std::size_t size() const {
+        return _leafCount;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return _leafCount == 0;
+    }
+
+    [[nodiscard]] uint64_t id(Proxy proxy) const {
+        return _nodes[proxy].id;
+    }
+
+    [[nodiscard]] const Aabb &bounds(Proxy proxy) const {
+        return _nodes[proxy].bounds;
+    }
+
+    /** @brief Appends the ids of the boxes overlapping box. **/
+    void queryAabb(const Aabb &box, std::vector<uint64_t> &out) const;
+
+    /** @brief Appends the ids of the boxes within radius of center. **/
+    void querySphere(const glm::dvec3 &center, double radius,
+                     std::vector<uint64_t> &out) const;
+
+    /** @brief Appends the ids of the boxes not fully outside the frustum.
+     * @details Planes follow the convention of the renderer's Frustum:
+     * normalized and pointing inwards. Whole subtrees inside every plane are
+     * reported without testing their leaves.
+     * */
+    void queryFrustum(const std::array<glm::dvec4, 6> &planes,
+                      std::vector<uint64_t> &out) const;
+
+    /** @brief Replaces out with the ids of the k boxes closest to point,
+     * nearest first. Boxes containing the point are at distance 0.
+     * */
+    void nearest(const glm::dvec3 &point, std::size_t k,
+                 std::vector<uint64_t> &out) const;
+
+private:
+    struct Node {
+        Aabb bounds;
+        // next free node while the node is free
+        uint32_t parent;
+        uint32_t left;
+        uint32_t right;
+        uint64_t id;
+        bool free;
+        bool moved;
+
+        [[nodiscard]] bool isLeaf() const {
+            return left == kNullProxy;
+        }
+    };
+
+    struct BuildItem {
+        uint32_t leaf;
+        glm::dvec3 centroid;
+    };
+
+    uint32_t allocateNode();
+    void freeNode(uint32_t index);
+    void setInternalBounds(uint32_t index, const Aabb &bounds);
+    void refitUpwards(uint32_t index);
+    uint32_t pickSibling(const Aabb &bounds) const;
+    uint32_t build(BuildItem *items, std::size_t count);
+
+    std::vector<Node> _nodes;
+    std::vector<Proxy> _moved;
+    uint32_t _root = kNullProxy;
+    uint32_t _freeHead = kNullProxy;
+    std::size_t _leafCount = 0;
+    // summed surface area of the internal nodes, kept up to date
+    double _internalArea = 0.0;
+    double _builtCost = 0.0;
+    std::size_t _builtLeafCount = 0;
+};
@@ -3,18 +3,25 @@
 #include <SDL2/SDL_events.h>
 #include <glm/detail/qualifier.hpp>
 #include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_double3.hpp>
 #include <glm/ext/vector_float3.hpp>
 
 class Camera {
 public:
     glm::vec3 velocity;
-    glm::vec3 position;
+    // double precision so the camera can move far from the world origin
+    glm::dvec3 position;
     // vertical rotation
     float pitch{0.f};
     // horizontal rotation
     float yaw{0.f};
 
     [[nodiscard]] glm::mat4 getViewMatrix() const;
+    /** @brief View matrix of a world translated so that origin is at 0.
+     * @details With an origin near the camera, the translation left in the
+     * matrix is small and keeps full float precision at any distance.
+     * */
+    [[nodiscard]] glm::mat4 getViewMatrix(const glm::dvec3& origin) const;
     [[nodiscard]] glm::mat4 getRotationMatrix() const;
 
     void processSDLEvent(const SDL_Event& e);
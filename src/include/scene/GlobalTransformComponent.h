@@ -1,6 +1,8 @@
 #pragma once
 
 #define GLM_ENABLE_EXPERIMENTAL
+#include <vector>
+
 #include "core/Logging.h"
 #include "flecs.h"
 #include "glm/gtx/orthonormalize.hpp"
@@ -16,4 +18,20 @@
 
 struct GlobalTransform {
     glm::f64mat4 TransformMatrix;
-};
\ No newline at end of file
+};
+
+/** @brief Singleton listing the entities queued for and written by the
+ * transform propagation pass.
+ * @details Plain arrays rather than tags, since adding and removing a tag
+ * moves the entity to another table, and doing so for every moving entity
+ * every frame costs more than the propagation itself.
+ * @see TransformSystem
+ * */
+struct TransformChanges {
+    //! queued by markTransformDirty() for the next pass, possibly repeated.
+    std::vector<flecs::entity_t> dirty;
+    //! GlobalTransforms written by the last pass, parents first. Kept until
+    //! the next pass starts, so systems running after PostUpdate can visit
+    //! only what moved this frame.
+    std::vector<flecs::entity_t> changed;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "GltfNodeComponent.h"
+#include "flecs.h"
+
+class VulkanEngine;
+
+/** @brief A glTF file instantiated as entities. **/
+struct ImportedGltf {
+    //! the engine instance drawing the file, to unregister once done.
+    SlotHandle mesh;
+    //! one entity per node, parents before their children.
+    std::vector<flecs::entity> entities;
+};
+
+/** @brief Registers a mesh instance of a glTF file and instantiates its node
+ * hierarchy as entities that drive it.
+ *
+ * @details Every node becomes an entity with a LocalTransform and a
+ * GlobalTransform, created in one bulk operation in the order of the file's
+ * render list, then linked with setRelation(). Nodes holding surfaces also
+ * get a GltfNodeComponent, through which GltfNodeSystem hands their
+ * propagated GlobalTransform to the engine as the world matrix of the node.
+ * The instance then only follows its entities.
+ *
+ * LocalTransform only has a uniform scale, so a node with a non uniform
+ * scale keeps its first axis scale.
+ *
+ * @param world The world to create the entities in.
+ * @param engine The engine to register the instance in.
+ * @param filePath The file, relative to the assets directory.
+ * @param parent Entity the top level nodes are attached to, if valid.
+ * @return The instance and the created entities.
+ * */
+ImportedGltf instantiateGltf(flecs::world &world, VulkanEngine &engine,
+                             const std::string &filePath,
+                             flecs::entity parent = {});
+
+/**
+ * @brief Sets up the GltfNodeSystem in the given world.
+ *
+ * @details Runs in PreStore, after the transform propagation, over the
+ * entities the last pass listed in TransformChanges, and forwards the
+ * GlobalTransform of those with a GltfNodeComponent to the engine, with one
+ * call per mesh instance.
+ *
+ * @param world The world to set up the system in.
+ * @param engine The engine drawing the instances. Must outlive the world.
+ * */
+void GltfNodeSystem(flecs::world &world, VulkanEngine &engine);
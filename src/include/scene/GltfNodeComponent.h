@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+
+#include "core/SlotMap.h"
+
+/**
+ * @brief A component that ties an entity to a node of a glTF mesh instance.
+ *
+ * @details
+ * The GlobalTransform of the entity is the world matrix the engine draws the
+ * surfaces of that node with. Set by instantiateGltf() on the nodes that
+ * hold surfaces.
+ *
+ * @see GltfNodeSystem
+ * */
+struct GltfNodeComponent {
+    SlotHandle mesh;    //!< handle of the instance in VulkanEngine::meshes.
+    uint32_t node;      //!< index of the node in its file's GLTFRenderList.
+};
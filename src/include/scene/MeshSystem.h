@@ -12,6 +12,11 @@
  * The MeshSystem is responsible for updating the MeshComponent of entities that
  * have a GlobalTransform
  *
+ * Only the entities the last propagation pass listed in TransformChanges are
+ * visited, and their matrices are handed to the graphics in a single batch,
+ * so a frame costs time proportional to what moved rather than to the number
+ * of meshes.
+ *
  * The system guarantees the following invariants after each update: <br>
  * - Every time the GlobalTransform of entity changes, the MeshComponent also
  * changes. <br>
@@ -1,28 +1,30 @@
 #pragma once
 
-#include <algorithm>
-#include <vector>
+#include <cstdint>
 
 #include "core/Logging.h"
 #include "flecs.h"
 
 /** @brief Entity component containing the parent entity.
+ *
+ * @details Children of one parent form an intrusive doubly linked list
+ * through their sibling links, so attaching and detaching a child is O(1)
+ * whatever the number of siblings.
  * @see ParentSystem
  * */
 struct Parent {
     flecs::entity parent;
+    flecs::entity previousSibling;
+    flecs::entity nextSibling;
 };
 
-/** @brief Entity component containing the children entities.
- *  @see ParentSystem
+/** @brief Entity component giving access to the children entities.
+ *
+ * @details Head of the sibling list stored in the children's Parent
+ * components. Use forEachChild() to walk it.
+ * @see ParentSystem
  * */
 struct Child {
-    std::vector<flecs::entity> children;
+    flecs::entity firstChild;
+    uint32_t count = 0;
 };
-
-/** @brief Entity component containing the previous parent entity.
- * @see ParentSystem
- * */
-struct PreviousParent {
-    flecs::entity parent;
-};
\ No newline at end of file
@@ -4,12 +4,14 @@
 #include "flecs.h"
 
 /** @brief Sets the parent of an entity.
+ * @details O(1): the child is unlinked from its previous siblings, if any,
+ * and linked in front of its new ones.
  * @param child The entity to set the parent of.
  * @param parent The entity to set as the parent.
  * */
 void setRelation(flecs::entity child, flecs::entity parent);
 
-/** @brief Removes the parent of an entity.
+/** @brief Removes the parent of an entity in O(1).
  * @param child The entity to remove the parent of.
  * */
 void removeRelation(flecs::entity child);
@@ -20,17 +22,45 @@ void removeRelation(flecs::entity child);
  * */
 void removeRelation(flecs::entity removing_child, flecs::entity parent);
 
+/** @brief Destroys an entity together with all of its descendants.
+ *
+ * @details The subtree is unlinked from the rest of the hierarchy once, then
+ * every entity in it is deleted in one deferred batch, without unlinking
+ * siblings one by one.
+ * @param root The topmost entity to destroy.
+ * */
+void destroySubtree(flecs::entity root);
+
+/** @brief Calls fn on every child of parent.
+ * @details fn may unlink or destroy the child it is given.
+ * */
+template <typename Fn>
+void forEachChild(flecs::entity parent, Fn&& fn) {
+    if (!parent.has<Child>()) {
+        return;
+    }
+    flecs::entity child = parent.get<Child>()->firstChild;
+    while (child.is_alive()) {
+        const flecs::entity next = child.get<Parent>()->nextSibling;
+        fn(child);
+        child = next;
+    }
+}
+
 /** @brief Sets up the ParentSystem in the given world.
  *
  * @details The system guarantees the following invariants after each update:
  * <br>
- * - Invalid or deleted entities that were children are removed from the
- * parent's child lists. <br>
- * - If the parent entity is deleted or invalid, its children are deleted. <br>
+ * - Deleted entities that were children are unlinked from their siblings.
+ * <br>
+ * - If the parent entity is deleted, its children are deleted. <br>
  * - If an entity changes its parent, it will be removed from the list of
  * children of the previous parent. <br>
  * - All dependent entities have exactly one parent and all parent entities have
  * at least one child.
+ *
+ * Relations have to be changed through setRelation() and removeRelation(),
+ * which maintain the sibling links.
  * @param world The world to set up the system in.
  * */
-void ParentSystem(flecs::world& world);
\ No newline at end of file
+void ParentSystem(flecs::world& world);
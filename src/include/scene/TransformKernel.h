@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+
+/** @brief Instruction sets the transform kernels can run on. **/
+enum class TransformIsa { Scalar, Avx2, Avx512 };
+
+/** @brief Strided views over the components of many TRS transforms.
+ *
+ * @details Element i of a stream lives at pointer[i * stride]. A stride of 1
+ * describes plain structure-of-arrays storage; a flecs column of
+ * LocalTransform is described by pointing each stream at the first
+ * component's member and using sizeof(LocalTransform) / sizeof(double) as
+ * the stride, so the kernels read table storage without copying it.
+ * */
+struct TrsStreams {
+    const double *positionX;
+    const double *positionY;
+    const double *positionZ;
+    const double *rotationX;
+    const double *rotationY;
+    const double *rotationZ;
+    const double *rotationW;
+    const double *scale;
+    std::size_t stride;
+};
+
+/** @brief Writable counterpart of TrsStreams. **/
+struct TrsOutputStreams {
+    double *positionX;
+    double *positionY;
+    double *positionZ;
+    double *rotationX;
+    double *rotationY;
+    double *rotationZ;
+    double *rotationW;
+    double *scale;
+    std::size_t stride;
+};
+
+/** @brief The widest instruction set both the build and the CPU support.
+ * Detected once and cached.
+ * */
+TransformIsa supportedTransformIsa();
+
+/** @brief Composes translate(position) * mat4_cast(rotation) * scale(scale)
+ * for count transforms.
+ *
+ * @details The matrix is built in closed form from the unit quaternion, so
+ * no intermediate matrices are multiplied. Results are column major, 16
+ * doubles per matrix, with matrix i starting at out + i * outStride. The
+ * vector paths handle 4 (AVX2) or 8 (AVX-512) transforms per iteration and
+ * agree with the scalar path up to rounding, as the compiler may fuse
+ * multiplies and adds differently on each.
+ *
+ * @param in transforms to compose.
+ * @param out destination of the first matrix.
+ * @param outStride distance between two matrices, in doubles, at least 16.
+ * @param count number of transforms.
+ * */
+void composeTrs(const TrsStreams &in, double *out, std::size_t outStride,
+                std::size_t count);
+
+/** @brief composeTrs() on an explicit instruction set, which must not be
+ * wider than supportedTransformIsa(). Meant for tests and benchmarks.
+ * */
+void composeTrs(TransformIsa isa, const TrsStreams &in, double *out,
+                std::size_t outStride, std::size_t count);
+
+/** @brief Whether a column major matrix is translate * rotate * scale with a
+ * uniform, non zero scale, up to a relative tolerance.
+ * */
+bool isUniformTrs(const double *matrix, double tolerance = 1e-9);
+
+/** @brief Expresses count global transforms relative to their parents, as
+ * inverse(parent) * global, split back into position, rotation and scale.
+ *
+ * @details Both matrices must satisfy isUniformTrs(). The inverse of such a
+ * parent is its transposed linear part divided by the squared scale, applied
+ * after subtracting the parent's translation, so neither a generic 4x4
+ * inverse nor a full decomposition is needed. The loop has no dependencies
+ * between elements; only the quaternion extraction branches.
+ *
+ * @param parents first parent matrix, 16 column major doubles.
+ * @param parentStride distance between two parent matrices, in doubles.
+ * @param globals first global matrix.
+ * @param globalStride distance between two global matrices, in doubles.
+ * @param out local transforms.
+ * @param count number of transforms.
+ * */
+void relativeTrs(const double *parents, std::size_t parentStride,
+                 const double *globals, std::size_t globalStride,
+                 const TrsOutputStreams &out, std::size_t count);
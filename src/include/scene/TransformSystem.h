@@ -1,11 +1,15 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 
 #include "GlobalTransformComponent.h"
 #include "LocalTransformComponent.h"
 #include "flecs.h"
 
+class JobSystem;
+
 /** @brief a method to set the local coordinates of an entity from a matrix.
  *
  * @param e entity into which the coordinates are set.
@@ -44,6 +48,38 @@ glm::f64mat4 getMatrixFromLocal(flecs::entity e);
 
 glm::f64mat4 getMatrixFromLocal(const LocalTransform &t);
 
+/** @brief Composes the matrices of many local coordinates at once.
+ *
+ * @details Runs the vector kernel of TransformKernel.h over contiguous
+ * components, typically flecs table columns, without copying them.
+ *
+ * @param locals first of count local coordinates.
+ * @param out first of count destinations.
+ * @param count number of entities.
+ * */
+void composeLocalMatrices(const LocalTransform *locals, GlobalTransform *out,
+                          std::size_t count);
+
+/** @brief Computes the local coordinates matching a global matrix under a
+ * parent, i.e. the decomposition of inverse(parentGlobal) * global.
+ *
+ * @details Uniformly scaled TRS matrices, which is everything the transform
+ * system produces, take a closed form path without a 4x4 inverse or a full
+ * decomposition. Other matrices fall back to glm::inverse and
+ * glm::decompose.
+ *
+ * @param parentGlobal global matrix of the parent, identity for roots.
+ * @param global global matrix of the entity.
+ * @return local coordinates of the entity.
+ * */
+LocalTransform localFromGlobal(const glm::f64mat4 &parentGlobal,
+                               const glm::f64mat4 &global);
+
+/** @brief Batched localFromGlobal() over count matrix pairs. **/
+void localsFromGlobals(const glm::f64mat4 *parentGlobals,
+                       const glm::f64mat4 *globals, LocalTransform *out,
+                       std::size_t count);
+
 /** @brief a method to rotate an entity locally.
  *
  * @param e entity to rotate.
@@ -218,20 +254,65 @@ void setGlobalFromEntity(flecs::entity e, const flecs::entity &parent);
  * */
 void inverseGlobal(flecs::entity e);
 
+/** @brief Singleton describing the last transform propagation pass. **/
+struct TransformPropagationStats {
+    uint32_t dirtyRoots = 0;       //!< topmost dirty entities.
+    uint32_t updatedEntities = 0;  //!< GlobalTransforms written.
+    uint32_t depth = 0;            //!< hierarchy levels walked.
+};
+
+/** @brief Queues an entity for the next propagation pass, which recomputes
+ * its GlobalTransform and those of its descendants.
+ * @details Only appends to TransformChanges, the entity stays in its table.
+ * */
+void markTransformDirty(flecs::entity e);
+
+/** @brief Recomputes the global coordinates of every dirty entity and of all
+ * of its descendants.
+ *
+ * @details Dirty entities without a dirty ancestor are the roots of the pass.
+ * The hierarchy below them is walked once, breadth first, so each parent is
+ * written before its children read it and each GlobalTransform is written
+ * exactly once. Children compose their local coordinates with the matrix
+ * computed for their parent during the walk, not with the parent's
+ * component, which entities with only a LocalTransform get once the pass
+ * ends. The queue of TransformChanges is emptied, and its changed list is
+ * replaced with the entities written by this pass.
+ *
+ * Each level is split into chunks processed by the job system, if one is
+ * given. A thread only writes the GlobalTransform of the entities in its
+ * chunk and only reads those of the level above, so no locking is needed.
+ *
+ * @param world world holding the entities.
+ * @param jobs threads to spread the work over, nullptr to stay on the
+ * calling thread.
+ * @return what the pass touched.
+ * */
+TransformPropagationStats propagateTransforms(flecs::world &world,
+                                              JobSystem *jobs = nullptr);
+
 /**
  * @brief Sets up the TransformSystem in the given world.
  *
  * @details
  *
- * The system guarantees the following invariants after each update: <br>
+ * Changing either set of coordinates only queues the entity with
+ * markTransformDirty(). Global coordinates are propagated once per frame, in
+ * PostUpdate, by propagateTransforms(), and its result is stored in the
+ * TransformPropagationStats singleton. The system guarantees the following
+ * invariants after each update: <br>
  * - Every time the parent's coordinates are changed, the children's coordinates
  * also changes. <br>
  * - When children change global coordinates, local coordinates change and vice
  * versa. <br>
  * - Children will always have local coordinates. <br>
+ * - Entities without a parent use their local coordinates, if any, as global
+ * ones. <br>
  *
  * @param world The world to set up the system in.
+ * @param jobs threads used by the propagation pass, nullptr to run it on the
+ * thread progressing the world. Must outlive the world.
  *
  * @see LocalTransformComponent, GlobalTransformComponent, ParentSystem.
  * */
-void TransformSystem(flecs::world &world);
\ No newline at end of file
+void TransformSystem(flecs::world &world, JobSystem *jobs = nullptr);
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "scene/BoundsSystem.h"
+
+#include "glm/common.hpp"
+#include "scene/TransformSystem.h"
+
+namespace {
+// the bounds are computed by the next propagation, which tags the entity
+void AddWorldBoundsIfLocalSet(flecs::entity e, const LocalBounds &) {
+    if (!e.has<WorldBounds>()) {
+        e.set<WorldBounds>({});
+    }
+    if (e.has<GlobalTransform>()) {
+        markTransformDirty(e);
+    }
+}
+
+void RemoveWorldBoundsIfLocalRemoved(flecs::entity e, const LocalBounds &) {
+    e.remove<WorldBounds>();
+}
+
+void RemoveFromSpatialIndex(flecs::entity e, const WorldBounds &wb) {
+    if (wb.proxy == Bvh::kNullProxy) {
+        return;
+    }
+    // the singleton may already be gone while the world shuts down
+    if (auto *index = e.world().get_mut<SpatialIndex>()) {
+        index->bvh.remove(wb.proxy);
+    }
+}
+}  // namespace
+
+Aabb transformBounds(const glm::f64mat4 &matrix, const LocalBounds &local) {
+    const glm::f64vec3 center(matrix * glm::f64vec4(local.center, 1.0));
+    glm::f64vec3 extents(0.0);
+    for (int column = 0; column < 3; column++) {
+        extents += glm::abs(glm::f64vec3(matrix[column])) *
+                   local.extents[column];
+    }
+    return {center - extents, center + extents};
+}
+
+void BoundsSystem(flecs::world &world) {
+    world.add<SpatialIndex>();
+
+    world.system<LocalBounds>("AddWorldBoundsIfLocalSet")
+            .kind(flecs::OnSet)
+            .each(AddWorldBoundsIfLocalSet);
+    world.system<LocalBounds>("RemoveWorldBoundsIfLocalRemoved")
+            .kind(flecs::OnRemove)
+            .each(RemoveWorldBoundsIfLocalRemoved);
+    world.system<WorldBounds>("RemoveFromSpatialIndex")
+            .kind(flecs::OnRemove)
+            .each(RemoveFromSpatialIndex);
+
+    // runs after the transform propagation in PostUpdate, and only sees the
+    // entities it moved
+    world.system("UpdateWorldBounds")
+            .kind(flecs::PreStore)
+            .run([](flecs::iter &it) {
+                flecs::world w = it.world();
+                Bvh &bvh = w.get_mut<SpatialIndex>()->bvh;
+                for (const flecs::entity_t id :
+                     w.get<TransformChanges>()->changed) {
+                    // destroyed since the pass
+                    if (!w.is_alive(id)) {
+                        continue;
+                    }
+                    const flecs::entity e = w.entity(id);
+                    const auto *gt = e.get<GlobalTransform>();
+                    const auto *lb = e.get<LocalBounds>();
+                    auto *wb = e.get_mut<WorldBounds>();
+                    if (gt == nullptr || lb == nullptr || wb == nullptr) {
+                        continue;
+                    }
+                    wb->bounds = transformBounds(gt->TransformMatrix, *lb);
+                    if (wb->proxy == Bvh::kNullProxy) {
+                        wb->proxy = bvh.insert(id, wb->bounds);
+                    } else {
+                        bvh.update(wb->proxy, wb->bounds);
+                    }
+                }
+                bvh.refit();
+            });
+}
@@ -0,0 +1,460 @@
+#include "scene/Bvh.h"
+
+#include <algorithm>
+#include <functional>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <queue>
+#include <utility>
+
+namespace {
+constexpr int kBinCount = 16;
+
+Aabb emptyAabb() {
+    constexpr double inf = std::numeric_limits<double>::infinity();
+    return {glm::dvec3(inf), glm::dvec3(-inf)};
+}
+
+double squaredDistance(const Aabb &box, const glm::dvec3 &point) {
+    const glm::dvec3 outside =
+            glm::max(glm::max(box.min - point, point - box.max), 0.0);
+    return glm::dot(outside, outside);
+}
+
+enum class Containment { Outside, Intersecting, Inside };
+
+Containment classify(const Aabb &box,
+                     const std::array<glm::dvec4, 6> &planes) {
+    Containment result = Containment::Inside;
+    for (const glm::dvec4 &plane : planes) {
+        const glm::dvec3 normal(plane);
+        // the corners furthest along and against the normal
+        glm::dvec3 positive;
+        glm::dvec3 negative;
+        for (int i = 0; i < 3; i++) {
+            positive[i] = normal[i] >= 0.0 ? box.max[i] : box.min[i];
+            negative[i] = normal[i] >= 0.0 ? box.min[i] : box.max[i];
+        }
+        if (glm::dot(normal, positive) + plane.w < 0.0) {
+            return Containment::Outside;
+        }
+        if (glm::dot(normal, negative) + plane.w < 0.0) {
+            result = Containment::Intersecting;
+        }
+    }
+    return result;
+}
+}  // namespace
+
+bool Aabb::overlaps(const Aabb &other) const {
+    return min.x <= other.max.x && other.min.x <= max.x &&
+           min.y <= other.max.y && other.min.y <= max.y &&
+           min.z <= other.max.z && other.min.z <= max.z;
+}
+
+double Aabb::surfaceArea() const {
+    const glm::dvec3 size = max - min;
+    return 2.0 * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+Aabb Aabb::merge(const Aabb &a, const Aabb &b) {
+    return {glm::min(a.min, b.min), glm::max(a.max, b.max)};
+}
+
+uint32_t Bvh::allocateNode() {
+    uint32_t index;
+    if (_freeHead != kNullProxy) {
+        index = _freeHead;
+        _freeHead = _nodes[index].parent;
+    } else {
+        index = static_cast<uint32_t>(_nodes.size());
+        _nodes.emplace_back();
+    }
+    _nodes[index] = Node{{glm::dvec3(0.0), glm::dvec3(0.0)},
+                         kNullProxy,
+                         kNullProxy,
+                         kNullProxy,
+                         0,
+                         false,
+                         false};
+    return index;
+}
+
+void Bvh::freeNode(uint32_t index) {
+    Node &node = _nodes[index];
+    node.free = true;
+    node.parent = _freeHead;
+    _freeHead = index;
+}
+
+void Bvh::setInternalBounds(uint32_t index, const Aabb &bounds) {
+    Node &node = _nodes[index];
+    _internalArea += bounds.surfaceArea() - node.bounds.surfaceArea();
+    node.bounds = bounds;
+}
+
+void Bvh::refitUpwards(uint32_t index) {
+    while (index != kNullProxy) {
+        const Node &node = _nodes[index];
+        const Aabb merged = Aabb::merge(_nodes[node.left].bounds,
+                                        _nodes[node.right].bounds);
+        // nothing above can change either
+        if (merged.min == node.bounds.min && merged.max == node.bounds.max) {
+            return;
+        }
+        setInternalBounds(index, merged);
+        index = node.parent;
+    }
+}
+
+uint32_t Bvh::pickSibling(const Aabb &bounds) const {
+    uint32_t index = _root;
+    while (!_nodes[index].isLeaf()) {
+        const Node &node = _nodes[index];
+        const double area = node.bounds.surfaceArea();
+        const double combinedArea =
+                Aabb::merge(node.bounds, bounds).surfaceArea();
+
+        // pairing with this node creates a parent of the combined size, and
+        // going further down grows this node anyway
+        const double cost = 2.0 * combinedArea;
+        const double inheritance = 2.0 * (combinedArea - area);
+        const auto descendCost = [&](uint32_t child) {
+            const Node &c = _nodes[child];
+            double grown = Aabb::merge(c.bounds, bounds).surfaceArea();
+            if (!c.isLeaf()) {
+                grown -= c.bounds.surfaceArea();
+            }
+            return grown + inheritance;
+        };
+        const double leftCost = descendCost(node.left);
+        const double rightCost = descendCost(node.right);
+
+        if (cost < leftCost && cost < rightCost) {
+            break;
+        }
+        index = leftCost < rightCost ? node.left : node.right;
+    }
+    return index;
+}
+
+Bvh::Proxy Bvh::insert(uint64_t id, const Aabb &bounds) {
+    const uint32_t leaf = allocateNode();
+    _nodes[leaf].bounds = bounds;
+    _nodes[leaf].id = id;
+    _leafCount++;
+
+    if (_root == kNullProxy) {
+        _root = leaf;
+        return leaf;
+    }
+
+    const uint32_t sibling = pickSibling(bounds);
+    const uint32_t oldParent = _nodes[sibling].parent;
+    const uint32_t parent = allocateNode();
+    _nodes[parent].parent = oldParent;
+    _nodes[parent].left = sibling;
+    _nodes[parent].right = leaf;
+    setInternalBounds(parent, Aabb::merge(_nodes[sibling].bounds, bounds));
+    _nodes[sibling].parent = parent;
+    _nodes[leaf].parent = parent;
+
+    if (oldParent == kNullProxy) {
+        _root = parent;
+    } else {
+        Node &old = _nodes[oldParent];
+        (old.left == sibling ? old.left : old.right) = parent;
+        refitUpwards(oldParent);
+    }
+    return leaf;
+}
+
+void Bvh::remove(Proxy proxy) {
+    _leafCount--;
+    const uint32_t parent = _nodes[proxy].parent;
+    freeNode(proxy);
+
+    if (parent == kNullProxy) {
+        _root = kNullProxy;
+        return;
+    }
+
+    const Node &collapsed = _nodes[parent];
+    const uint32_t sibling =
+            collapsed.left == proxy ? collapsed.right : collapsed.left;
+    const uint32_t grandParent = collapsed.parent;
+    _internalArea -= collapsed.bounds.surfaceArea();
+    freeNode(parent);
+
+    _nodes[sibling].parent = grandParent;
+    if (grandParent == kNullProxy) {
+        _root = sibling;
+    } else {
+        Node &grand = _nodes[grandParent];
+        (grand.left == parent ? grand.left : grand.right) = sibling;
+        refitUpwards(grandParent);
+    }
+}
+
+void Bvh::update(Proxy proxy, const Aabb &bounds) {
+    Node &node = _nodes[proxy];
+    node.bounds = bounds;
+    if (!node.moved) {
+        node.moved = true;
+        _moved.push_back(proxy);
+    }
+}
+
+bool Bvh::refit() {
+    for (const Proxy proxy : _moved) {
+        Node &node = _nodes[proxy];
+        // removed, or removed and reused, since it moved
+        if (node.free || !node.isLeaf() || !node.moved) {
+            continue;
+        }
+        node.moved = false;
+        refitUpwards(node.parent);
+    }
+    _moved.clear();
+
+    if (_leafCount < 2) {
+        return false;
+    }
+    if (_builtLeafCount == 0 || _leafCount > 2 * _builtLeafCount ||
+        cost() > kRebuildRatio * _builtCost) {
+        rebuild();
+        return true;
+    }
+    return false;
+}
+
+void Bvh::rebuild() {
+    std::vector<BuildItem> items;
+    items.reserve(_leafCount);
+    for (uint32_t i = 0; i < _nodes.size(); i++) {
+        Node &node = _nodes[i];
+        if (node.free) {
+            continue;
+        }
+        if (node.isLeaf()) {
+            node.moved = false;
+            items.push_back({i, (node.bounds.min + node.bounds.max) * 0.5});
+        } else {
+            freeNode(i);
+        }
+    }
+    _moved.clear();
+
+    _internalArea = 0.0;
+    _root = items.empty() ? kNullProxy : build(items.data(), items.size());
+    if (_root != kNullProxy) {
+        _nodes[_root].parent = kNullProxy;
+    }
+    _builtCost = cost();
+    _builtLeafCount = _leafCount;
+}
+
+uint32_t Bvh::build(BuildItem *items, std::size_t count) {
+    if (count == 1) {
+        return items[0].leaf;
+    }
+
+    glm::dvec3 centroidMin = items[0].centroid;
+    glm::dvec3 centroidMax = items[0].centroid;
+    for (std::size_t i = 1; i < count; i++) {
+        centroidMin = glm::min(centroidMin, items[i].centroid);
+        centroidMax = glm::max(centroidMax, items[i].centroid);
+    }
+    const glm::dvec3 spread = centroidMax - centroidMin;
+    int axis = spread.x > spread.y ? 0 : 1;
+    if (spread.z > spread[axis]) {
+        axis = 2;
+    }
+
+    std::size_t split = 0;
+    if (spread[axis] > 0.0) {
+        const double scale = kBinCount / spread[axis];
+        const auto binOf = [&](const BuildItem &item) {
+            return std::min(kBinCount - 1,
+                            static_cast<int>((item.centroid[axis] -
+                                              centroidMin[axis]) *
+                                             scale));
+        };
+
+        std::array<Aabb, kBinCount> binBounds;
+        std::array<std::size_t, kBinCount> binCounts{};
+        binBounds.fill(emptyAabb());
+        for (std::size_t i = 0; i < count; i++) {
+            const int bin = binOf(items[i]);
+            binCounts[bin]++;
+            binBounds[bin] =
+                    Aabb::merge(binBounds[bin], _nodes[items[i].leaf].bounds);
+        }
+
+        // cost of everything right of each boundary, swept from the end
+        std::array<double, kBinCount> rightArea{};
+        std::array<std::size_t, kBinCount> rightCount{};
+        Aabb accumulated = emptyAabb();
+        std::size_t accumulatedCount = 0;
+        for (int bin = kBinCount - 1; bin > 0; bin--) {
+            accumulated = Aabb::merge(accumulated, binBounds[bin]);
+            accumulatedCount += binCounts[bin];
+            rightArea[bin] =
+                    accumulatedCount > 0 ? accumulated.surfaceArea() : 0.0;
+            rightCount[bin] = accumulatedCount;
+        }
+
+        double bestCost = std::numeric_limits<double>::infinity();
+        int bestBin = -1;
+        accumulated = emptyAabb();
+        accumulatedCount = 0;
+        for (int bin = 0; bin < kBinCount - 1; bin++) {
+            accumulated = Aabb::merge(accumulated, binBounds[bin]);
+            accumulatedCount += binCounts[bin];
+            if (accumulatedCount == 0 || rightCount[bin + 1] == 0) {
+                continue;
+            }
+            const double cost =
+                    static_cast<double>(accumulatedCount) *
+                            accumulated.surfaceArea() +
+                    static_cast<double>(rightCount[bin + 1]) *
+                            rightArea[bin + 1];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestBin = bin;
+            }
+        }
+
+        if (bestBin >= 0) {
+            split = static_cast<std::size_t>(
+                    std::partition(items, items + count,
+                                   [&](const BuildItem &item) {
+                                       return binOf(item) <= bestBin;
+                                   }) -
+                    items);
+        }
+    }
+    // coincident centroids, the median keeps the tree balanced
+    if (split == 0 || split == count) {
+        split = count / 2;
+        std::nth_element(items, items + split, items + count,
+                         [axis](const BuildItem &a, const BuildItem &b) {
+                             return a.centroid[axis] < b.centroid[axis];
+                         });
+    }
+
+    const uint32_t left = build(items, split);
+    const uint32_t right = build(items + split, count - split);
+    const uint32_t node = allocateNode();
+    _nodes[node].left = left;
+    _nodes[node].right = right;
+    _nodes[left].parent = node;
+    _nodes[right].parent = node;
+    setInternalBounds(node,
+                      Aabb::merge(_nodes[left].bounds, _nodes[right].bounds));
+    return node;
+}
+
+double Bvh::cost() const {
+    if (_root == kNullProxy || _nodes[_root].isLeaf()) {
+        return 0.0;
+    }
+    const double rootArea = _nodes[_root].bounds.surfaceArea();
+    return rootArea > 0.0 ? _internalArea / rootArea : 0.0;
+}
+
+void Bvh::queryAabb(const Aabb &box, std::vector<uint64_t> &out) const {
+    if (_root == kNullProxy) {
+        return;
+    }
+    std::vector<uint32_t> stack{_root};
+    while (!stack.empty()) {
+        const Node &node = _nodes[stack.back()];
+        stack.pop_back();
+        if (!node.bounds.overlaps(box)) {
+            continue;
+        }
+        if (node.isLeaf()) {
+            out.push_back(node.id);
+        } else {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+
+void Bvh::querySphere(const glm::dvec3 &center, double radius,
+                      std::vector<uint64_t> &out) const {
+    if (_root == kNullProxy) {
+        return;
+    }
+    const double radiusSquared = radius * radius;
+    std::vector<uint32_t> stack{_root};
+    while (!stack.empty()) {
+        const Node &node = _nodes[stack.back()];
+        stack.pop_back();
+        if (squaredDistance(node.bounds, center) > radiusSquared) {
+            continue;
+        }
+        if (node.isLeaf()) {
+            out.push_back(node.id);
+        } else {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+
+void Bvh::queryFrustum(const std::array<glm::dvec4, 6> &planes,
+                       std::vector<uint64_t> &out) const {
+    if (_root == kNullProxy) {
+        return;
+    }
+    // second member: the node is known to be inside every plane
+    std::vector<std::pair<uint32_t, bool>> stack{{_root, false}};
+    while (!stack.empty()) {
+        const auto [index, inside] = stack.back();
+        stack.pop_back();
+        const Node &node = _nodes[index];
+
+        bool contained = inside;
+        if (!contained) {
+            const Containment containment = classify(node.bounds, planes);
+            if (containment == Containment::Outside) {
+                continue;
+            }
+            contained = containment == Containment::Inside;
+        }
+        if (node.isLeaf()) {
+            out.push_back(node.id);
+        } else {
+            stack.emplace_back(node.left, contained);
+            stack.emplace_back(node.right, contained);
+        }
+    }
+}
+
+void Bvh::nearest(const glm::dvec3 &point, std::size_t k,
+                  std::vector<uint64_t> &out) const {
+    out.clear();
+    if (_root == kNullProxy || k == 0) {
+        return;
+    }
+    // a node is never closer than its parent, so leaves come out of the
+    // queue in order of distance
+    using Entry = std::pair<double, uint32_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<>> open;
+    open.emplace(squaredDistance(_nodes[_root].bounds, point), _root);
+    while (!open.empty() && out.size() < k) {
+        const Node &node = _nodes[open.top().second];
+        open.pop();
+        if (node.isLeaf()) {
+            out.push_back(node.id);
+            continue;
+        }
+        open.emplace(squaredDistance(_nodes[node.left].bounds, point),
+                     node.left);
+        open.emplace(squaredDistance(_nodes[node.right].bounds, point),
+                     node.right);
+    }
+}
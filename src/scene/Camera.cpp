@@ -5,7 +5,7 @@
 
 void Camera::update() {
     const glm::mat4 cameraRotation = getRotationMatrix();
-    position += glm::vec3(cameraRotation * glm::vec4(velocity * 0.05f, 0.f));
+    position += glm::dvec3(cameraRotation * glm::vec4(velocity * 0.05f, 0.f));
 }
 
 void Camera::processSDLEvent(const SDL_Event& e) {
@@ -46,11 +46,15 @@ void Camera::processSDLEvent(const SDL_Event& e) {
 }
 
 glm::mat4 Camera::getViewMatrix() const {
+    return getViewMatrix(glm::dvec3(0.0));
+}
+
+glm::mat4 Camera::getViewMatrix(const glm::dvec3& origin) const {
     // to create a correct model view, we need to move the world in opposite
     // direction to the camera
     //  so we will create the camera model matrix and invert
     const glm::mat4 cameraTranslation =
-            glm::translate(glm::mat4(1.f), position);
+            glm::translate(glm::mat4(1.f), glm::vec3(position - origin));
     const glm::mat4 cameraRotation = getRotationMatrix();
     return glm::inverse(cameraTranslation * cameraRotation);
 }
@@ -0,0 +1,129 @@
+#include "scene/GltfImporter.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "graphics/vulkan/vk_engine.h"
+#include "graphics/vulkan/vk_loader.h"
+#include "scene/ParentSystem.h"
+#include "scene/TransformSystem.h"
+
+ImportedGltf instantiateGltf(flecs::world &world, VulkanEngine &engine,
+                             const std::string &filePath,
+                             flecs::entity parent) {
+    ImportedGltf imported{engine.registerMesh(filePath), {}};
+    const GLTFRenderList &list =
+            engine.meshes.get(imported.mesh)->asset->renderList;
+    const std::size_t count = list.nodes.size();
+    if (count == 0) {
+        return imported;
+    }
+
+    // globals are composed in double from the locals rather than taken from
+    // the float world matrices, so that the observers recomputing locals
+    // from them once the relations are set get the same values back
+    const glm::f64mat4 top = parent.is_valid() && parent.has<GlobalTransform>()
+                                     ? parent.get<GlobalTransform>()
+                                               ->TransformMatrix
+                                     : glm::f64mat4(1.0);
+    std::vector<LocalTransform> locals(count);
+    std::vector<GlobalTransform> globals(count);
+    for (std::size_t i = 0; i < count; i++) {
+        locals[i] = localFromGlobal(glm::f64mat4(1.0),
+                                    glm::f64mat4(list.localTransforms[i]));
+        const glm::f64mat4 &parentGlobal =
+                list.parents[i] == GLTFRenderList::kNoParent
+                        ? top
+                        : globals[list.parents[i]].TransformMatrix;
+        globals[i].TransformMatrix =
+                parentGlobal * getMatrixFromLocal(locals[i]);
+    }
+
+    ecs_bulk_desc_t desc{};
+    desc.count = static_cast<int32_t>(count);
+    desc.ids[0] = world.component<LocalTransform>().id();
+    desc.ids[1] = world.component<GlobalTransform>().id();
+    void *data[] = {locals.data(), globals.data()};
+    desc.data = data;
+    const ecs_entity_t *ids = ecs_bulk_init(world, &desc);
+
+    imported.entities.reserve(count);
+    for (std::size_t i = 0; i < count; i++) {
+        imported.entities.push_back(world.entity(ids[i]));
+    }
+
+    std::vector<bool> drawn(count, false);
+    for (const uint32_t node : list.surfaceNodes) {
+        drawn[node] = true;
+    }
+
+    std::vector<uint32_t> nodes;
+    std::vector<glm::dmat4> worlds;
+    for (std::size_t i = 0; i < count; i++) {
+        flecs::entity e = imported.entities[i];
+        if (list.parents[i] != GLTFRenderList::kNoParent) {
+            setRelation(e, imported.entities[list.parents[i]]);
+        } else if (parent.is_valid()) {
+            setRelation(e, parent);
+        }
+        if (drawn[i]) {
+            const auto node = static_cast<uint32_t>(i);
+            e.set(GltfNodeComponent{imported.mesh, node});
+            nodes.push_back(node);
+            worlds.push_back(globals[i].TransformMatrix);
+        }
+    }
+    // the bulk creation emits no OnSet, the first propagation may not
+    // forward every node
+    engine.setMeshNodeTransforms(imported.mesh, nodes, worlds);
+    return imported;
+}
+
+void GltfNodeSystem(flecs::world &world, VulkanEngine &engine) {
+    // runs after the transform propagation in PostUpdate, and only sees the
+    // entities it moved
+    world.system("UpdateGltfNodes")
+            .kind(flecs::PreStore)
+            .run([&engine](flecs::iter &it) {
+                flecs::world w = it.world();
+                struct NodeUpdate {
+                    SlotHandle mesh;
+                    uint32_t node;
+                    glm::dmat4 world;
+                };
+                std::vector<NodeUpdate> updates;
+                for (const flecs::entity_t id :
+                     w.get<TransformChanges>()->changed) {
+                    // destroyed since the pass
+                    if (!w.is_alive(id)) {
+                        continue;
+                    }
+                    const flecs::entity e = w.entity(id);
+                    const auto *gn = e.get<GltfNodeComponent>();
+                    const auto *gt = e.get<GlobalTransform>();
+                    if (gn != nullptr && gt != nullptr) {
+                        updates.push_back(
+                                {gn->mesh, gn->node, gt->TransformMatrix});
+                    }
+                }
+
+                // one engine call per instance
+                std::ranges::stable_sort(updates, {}, &NodeUpdate::mesh);
+                std::vector<uint32_t> nodes;
+                std::vector<glm::dmat4> worlds;
+                for (std::size_t begin = 0; begin < updates.size();) {
+                    nodes.clear();
+                    worlds.clear();
+                    std::size_t end = begin;
+                    while (end < updates.size() &&
+                           updates[end].mesh == updates[begin].mesh) {
+                        nodes.push_back(updates[end].node);
+                        worlds.push_back(updates[end].world);
+                        end++;
+                    }
+                    engine.setMeshNodeTransforms(updates[begin].mesh, nodes,
+                                                 worlds);
+                    begin = end;
+                }
+            });
+}
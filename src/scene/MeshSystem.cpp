@@ -1,10 +1,16 @@
 #include "scene/MeshSystem.h"
 
-namespace {
+#include <vector>
+
+#include "scene/TransformSystem.h"
 
-void UpdateMesh(flecs::entity e, const GlobalTransform &gt) {
-    engine::graphics::Graphics::getInstance()->set_mesh_instance_transform(
-            e.get_mut<MeshComponent>()->MeshID, gt.TransformMatrix);
+namespace {
+// a mesh attached to an entity that does not move still needs its transform
+// once
+void MarkDirtyIfMeshSet(flecs::entity e, const MeshComponent &) {
+    if (e.has<GlobalTransform>()) {
+        markTransformDirty(e);
+    }
 }
 
 void DestroyMesh(const MeshComponent &mc) {
@@ -12,11 +18,40 @@ void DestroyMesh(const MeshComponent &mc) {
 }
 }  // namespace
 
-void MeshSystem(const flecs::world &world) {
-    world.system<GlobalTransform>("UpdateMesh")
-            .kind(flecs::OnUpdate)
-            .each(UpdateMesh);
+void MeshSystem(flecs::world &world) {
+    world.system<MeshComponent>("MarkDirtyIfMeshSet")
+            .kind(flecs::OnSet)
+            .each(MarkDirtyIfMeshSet);
+
+    // runs after the transform propagation in PostUpdate, and only sees the
+    // entities it moved
+    world.system("UpdateMesh")
+            .kind(flecs::PreStore)
+            .run([](flecs::iter &it) {
+                flecs::world w = it.world();
+                std::vector<uint64_t> ids;
+                std::vector<glm::dmat4> matrices;
+                for (const flecs::entity_t id :
+                     w.get<TransformChanges>()->changed) {
+                    // destroyed since the pass
+                    if (!w.is_alive(id)) {
+                        continue;
+                    }
+                    const flecs::entity e = w.entity(id);
+                    const auto *mc = e.get<MeshComponent>();
+                    const auto *gt = e.get<GlobalTransform>();
+                    if (mc != nullptr && gt != nullptr) {
+                        ids.push_back(mc->MeshID);
+                        matrices.push_back(gt->TransformMatrix);
+                    }
+                }
+                if (!ids.empty()) {
+                    engine::graphics::Graphics::getInstance()
+                            ->set_mesh_instance_transforms(ids, matrices);
+                }
+            });
+
     world.system<MeshComponent>("DestroyMesh")
             .kind(flecs::OnRemove)
             .each(DestroyMesh);
-}
\ No newline at end of file
+}
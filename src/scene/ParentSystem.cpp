@@ -1,49 +1,69 @@
 #include "scene/ParentSystem.h"
 
+#include <vector>
+
 namespace {
-void updateParent(flecs::entity e, const Parent &p) {
-    if (!p.parent.is_alive() || !p.parent.has<Child>()) {
-        e.destruct();
-    } else {
-        if (p.parent.has<Child>()) {
-            auto *child = p.parent.get_mut<Child>();
-            child->children.push_back(e);
-        }
+// takes child out of its parent's sibling list, leaving its Parent component
+// pointing nowhere
+void unlink(flecs::entity child) {
+    auto *link = child.get_mut<Parent>();
+    const flecs::entity parent = link->parent;
+
+    if (link->previousSibling.is_alive()) {
+        link->previousSibling.get_mut<Parent>()->nextSibling =
+                link->nextSibling;
+    } else if (parent.is_alive() && parent.has<Child>()) {
+        parent.get_mut<Child>()->firstChild = link->nextSibling;
+    }
+    if (link->nextSibling.is_alive()) {
+        link->nextSibling.get_mut<Parent>()->previousSibling =
+                link->previousSibling;
+    }
+
+    *link = Parent{};
+
+    if (parent.is_alive() && parent.has<Child>() &&
+        --parent.get_mut<Child>()->count == 0) {
+        parent.remove<Child>();
     }
 }
 
-void updateChild(Child &c) {
-    auto &children = c.children;
-    const auto newEnd =
-            std::ranges::remove_if(children, [](const flecs::entity &child) {
-                return (!child.is_alive() || !child.has<Parent>());
-            }).begin();
-    children.erase(newEnd, children.end());
+void link(flecs::entity child, flecs::entity parent) {
+    Parent relation{parent, flecs::entity(), flecs::entity()};
+    if (parent.has<Child>()) {
+        auto *children = parent.get_mut<Child>();
+        relation.nextSibling = children->firstChild;
+        children->firstChild.get_mut<Parent>()->previousSibling = child;
+        children->firstChild = child;
+        children->count++;
+    } else {
+        parent.set<Child>({child, 1});
+    }
+    // set, not get_mut, so that observers such as the transform system see
+    // the new parent
+    child.set<Parent>(relation);
 }
 
-void removeChild(flecs::entity e, const Child &c) {
-    if (c.children.empty()) {
-        e.remove<Child>();
+// a child deleted on its own leaves a hole in the sibling list
+void unlinkChild(flecs::entity e, const Parent &p) {
+    if (p.parent.is_alive()) {
+        unlink(e);
     }
 }
 
-void changeParent(flecs::entity e, Parent &p, const PreviousParent &pp) {
-    if (pp.parent.is_alive() and pp.parent.has<Child>()) {
-        auto *child = pp.parent.get_mut<Child>();
-        const auto newEnd =
-                std::ranges::remove_if(child->children,
-                                       [e](const flecs::entity &e_child) {
-                                           return e_child == e;
-                                       })
-                        .begin();
-        child->children.erase(newEnd, child->children.end());
+// children do not outlive their parent
+void destroyChildren(const Child &c) {
+    std::vector<flecs::entity> children;
+    children.reserve(c.count);
+    for (flecs::entity child = c.firstChild; child.is_alive();
+         child = child.get<Parent>()->nextSibling) {
+        children.push_back(child);
     }
-    if (p.parent.is_alive()) {
-        auto *child = p.parent.get_mut<Child>();
-        child->children.push_back(e);
+    for (const flecs::entity child : children) {
+        // the parent is going away, there is nothing left to unlink from
+        *child.get_mut<Parent>() = Parent{};
+        child.destruct();
     }
-    p.parent = pp.parent;
-    e.remove<PreviousParent>();
 }
 }  // namespace
 
@@ -71,18 +91,10 @@ void setRelation(flecs::entity child, flecs::entity parent) {
     if (child.has<Parent>()) {
         if (child.get<Parent>()->parent == parent) {
             return;
-        } else {
-            child.set<PreviousParent>({child.get<Parent>()->parent});
-        }
-    }
-    if (parent.has<Child>()) {
-        auto &children = parent.get_mut<Child>()->children;
-        if (std::ranges::find(children, child) != children.end()) {
-            return;
         }
-        children.push_back(child);
+        unlink(child);
     }
-    child.set<Parent>({parent});
+    link(child, parent);
 }
 
 void removeRelation(flecs::entity child) {
@@ -94,13 +106,14 @@ void removeRelation(flecs::entity child) {
         return;
     }
 #endif
+    unlink(child);
     child.remove<Parent>();
 }
 
 void removeRelation(flecs::entity removing_child, flecs::entity parent) {
 #ifndef NDEBUG
     if (!parent.is_alive() || !parent.has<Child>() ||
-        !parent.get<Child>()->children.empty()) {
+        parent.get<Child>()->count == 0) {
         LOGWF("Trying to remove entity {} from parent {}, but parent is not "
               "alive or has no children",
               removing_child.name().c_str(), parent.name().c_str());
@@ -113,24 +126,51 @@ void removeRelation(flecs::entity removing_child, flecs::entity parent) {
         return;
     }
 #endif
-    auto &children = parent.get_mut<Child>()->children;
-    const auto newEnd = std::ranges::remove_if(
-                                children,
-                                [removing_child](const flecs::entity &child) {
-                                    return child == removing_child;
-                                })
-                                .begin();
-    children.erase(newEnd, children.end());
+    if (removing_child.get<Parent>()->parent == parent) {
+        removeRelation(removing_child);
+    }
 }
 
-void ParentSystem(const flecs::world &world) {
-    world.system<Parent>("UpdateParent").kind(flecs::OnAdd).each(updateParent);
+void destroySubtree(flecs::entity root) {
+    if (!root.is_alive()) {
+        return;
+    }
+    if (root.has<Parent>()) {
+        removeRelation(root);
+    }
 
-    world.system<Child>("UpdateChild").kind(flecs::OnSet).each(updateChild);
+    std::vector<flecs::entity> subtree{root};
+    for (std::size_t i = 0; i < subtree.size(); i++) {
+        forEachChild(subtree[i], [&subtree](flecs::entity child) {
+            subtree.push_back(child);
+        });
+    }
 
-    world.system<Child>("RemoveChild").kind(flecs::OnRemove).each(removeChild);
+    // every link points inside the subtree, so clearing them all lets the
+    // observers skip the per entity unlinking
+    for (const flecs::entity e : subtree) {
+        if (e.has<Parent>()) {
+            *e.get_mut<Parent>() = Parent{};
+        }
+        if (e.has<Child>()) {
+            *e.get_mut<Child>() = Child{};
+        }
+    }
+
+    flecs::world world = root.world();
+    world.defer_begin();
+    for (const flecs::entity e : subtree) {
+        e.destruct();
+    }
+    world.defer_end();
+}
 
-    world.system<Parent, PreviousParent>("ChangeParent")
-            .kind(flecs::OnAdd)
-            .each(changeParent);
-}
\ No newline at end of file
+void ParentSystem(flecs::world &world) {
+    world.system<Parent>("UnlinkChild")
+            .kind(flecs::OnRemove)
+            .each(unlinkChild);
+
+    world.system<Child>("DestroyChildren")
+            .kind(flecs::OnRemove)
+            .each(destroyChildren);
+}
@@ -0,0 +1,392 @@
+#include "scene/TransformKernel.h"
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define TRANSFORM_KERNEL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only emit AVX instructions inside functions that ask for
+// them, which keeps the rest of the build on the baseline instruction set.
+// MSVC accepts the intrinsics anywhere.
+#if defined(__GNUC__) || defined(__clang__)
+#define TRANSFORM_TARGET(isa) __attribute__((target(isa)))
+#else
+#define TRANSFORM_TARGET(isa)
+#endif
+
+namespace {
+void composeScalar(const TrsStreams &in, double *out, std::size_t outStride,
+                   std::size_t begin, std::size_t count) {
+    for (std::size_t i = begin; i < count; i++) {
+        const std::size_t j = i * in.stride;
+        const double x = in.rotationX[j];
+        const double y = in.rotationY[j];
+        const double z = in.rotationZ[j];
+        const double w = in.rotationW[j];
+        const double s = in.scale[j];
+
+        // same operations as the vector paths
+        const double x2 = x + x;
+        const double y2 = y + y;
+        const double z2 = z + z;
+        const double xx = x * x2;
+        const double yy = y * y2;
+        const double zz = z * z2;
+        const double xy = x * y2;
+        const double xz = x * z2;
+        const double yz = y * z2;
+        const double wx = w * x2;
+        const double wy = w * y2;
+        const double wz = w * z2;
+
+        double *m = out + i * outStride;
+        m[0] = (1.0 - (yy + zz)) * s;
+        m[1] = (xy + wz) * s;
+        m[2] = (xz - wy) * s;
+        m[3] = 0.0;
+        m[4] = (xy - wz) * s;
+        m[5] = (1.0 - (xx + zz)) * s;
+        m[6] = (yz + wx) * s;
+        m[7] = 0.0;
+        m[8] = (xz + wy) * s;
+        m[9] = (yz - wx) * s;
+        m[10] = (1.0 - (xx + yy)) * s;
+        m[11] = 0.0;
+        m[12] = in.positionX[j];
+        m[13] = in.positionY[j];
+        m[14] = in.positionZ[j];
+        m[15] = 1.0;
+    }
+}
+
+#if defined(TRANSFORM_KERNEL_X86)
+TRANSFORM_TARGET("avx2")
+inline __m256d load4(const double *p, std::size_t stride, std::size_t i,
+                     __m256i offsets) {
+    if (stride == 1) {
+        return _mm256_loadu_pd(p + i);
+    }
+    return _mm256_mask_i64gather_pd(_mm256_setzero_pd(), p + i * stride,
+                                    offsets,
+                                    _mm256_castsi256_pd(_mm256_set1_epi64x(-1)),
+                                    8);
+}
+
+// writes one column of 4 matrices given its 4 rows across the lanes
+TRANSFORM_TARGET("avx2")
+inline void storeColumn4(double *out, std::size_t outStride, std::size_t column,
+                         __m256d r0, __m256d r1, __m256d r2, __m256d r3) {
+    const __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+    const __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+    const __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+    const __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+
+    double *m = out + column * 4;
+    _mm256_storeu_pd(m, _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(m + outStride, _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(m + 2 * outStride, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(m + 3 * outStride, _mm256_permute2f128_pd(t1, t3, 0x31));
+}
+
+TRANSFORM_TARGET("avx2")
+std::size_t composeAvx2(const TrsStreams &in, double *out,
+                        std::size_t outStride, std::size_t begin,
+                        std::size_t count) {
+    const auto stride = static_cast<int64_t>(in.stride);
+    const __m256i offsets =
+            _mm256_set_epi64x(3 * stride, 2 * stride, stride, 0);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d zero = _mm256_setzero_pd();
+
+    std::size_t i = begin;
+    for (; i + 4 <= count; i += 4) {
+        const __m256d x = load4(in.rotationX, in.stride, i, offsets);
+        const __m256d y = load4(in.rotationY, in.stride, i, offsets);
+        const __m256d z = load4(in.rotationZ, in.stride, i, offsets);
+        const __m256d w = load4(in.rotationW, in.stride, i, offsets);
+        const __m256d s = load4(in.scale, in.stride, i, offsets);
+
+        const __m256d x2 = _mm256_add_pd(x, x);
+        const __m256d y2 = _mm256_add_pd(y, y);
+        const __m256d z2 = _mm256_add_pd(z, z);
+        const __m256d xx = _mm256_mul_pd(x, x2);
+        const __m256d yy = _mm256_mul_pd(y, y2);
+        const __m256d zz = _mm256_mul_pd(z, z2);
+        const __m256d xy = _mm256_mul_pd(x, y2);
+        const __m256d xz = _mm256_mul_pd(x, z2);
+        const __m256d yz = _mm256_mul_pd(y, z2);
+        const __m256d wx = _mm256_mul_pd(w, x2);
+        const __m256d wy = _mm256_mul_pd(w, y2);
+        const __m256d wz = _mm256_mul_pd(w, z2);
+
+        double *m = out + i * outStride;
+        storeColumn4(
+                m, outStride, 0,
+                _mm256_mul_pd(_mm256_sub_pd(one, _mm256_add_pd(yy, zz)), s),
+                _mm256_mul_pd(_mm256_add_pd(xy, wz), s),
+                _mm256_mul_pd(_mm256_sub_pd(xz, wy), s), zero);
+        storeColumn4(
+                m, outStride, 1, _mm256_mul_pd(_mm256_sub_pd(xy, wz), s),
+                _mm256_mul_pd(_mm256_sub_pd(one, _mm256_add_pd(xx, zz)), s),
+                _mm256_mul_pd(_mm256_add_pd(yz, wx), s), zero);
+        storeColumn4(
+                m, outStride, 2, _mm256_mul_pd(_mm256_add_pd(xz, wy), s),
+                _mm256_mul_pd(_mm256_sub_pd(yz, wx), s),
+                _mm256_mul_pd(_mm256_sub_pd(one, _mm256_add_pd(xx, yy)), s),
+                zero);
+        storeColumn4(m, outStride, 3,
+                     load4(in.positionX, in.stride, i, offsets),
+                     load4(in.positionY, in.stride, i, offsets),
+                     load4(in.positionZ, in.stride, i, offsets), one);
+    }
+    return i;
+}
+
+TRANSFORM_TARGET("avx512f")
+inline __m512d load8(const double *p, std::size_t stride, std::size_t i,
+                     __m512i offsets) {
+    if (stride == 1) {
+        return _mm512_loadu_pd(p + i);
+    }
+    // the masked form avoids reading an uninitialized source register
+    return _mm512_mask_i64gather_pd(_mm512_setzero_pd(), 0xFF, offsets,
+                                    p + i * stride, 8);
+}
+
+// splits the 8 lanes into two groups of 4 matrices
+TRANSFORM_TARGET("avx512f")
+inline void storeColumn8(double *out, std::size_t outStride, std::size_t column,
+                         __m512d r0, __m512d r1, __m512d r2, __m512d r3) {
+    storeColumn4(out, outStride, column, _mm512_castpd512_pd256(r0),
+                 _mm512_castpd512_pd256(r1), _mm512_castpd512_pd256(r2),
+                 _mm512_castpd512_pd256(r3));
+    storeColumn4(out + 4 * outStride, outStride, column,
+                 _mm512_extractf64x4_pd(r0, 1), _mm512_extractf64x4_pd(r1, 1),
+                 _mm512_extractf64x4_pd(r2, 1), _mm512_extractf64x4_pd(r3, 1));
+}
+
+TRANSFORM_TARGET("avx512f")
+std::size_t composeAvx512(const TrsStreams &in, double *out,
+                          std::size_t outStride, std::size_t begin,
+                          std::size_t count) {
+    const auto stride = static_cast<int64_t>(in.stride);
+    const __m512i offsets =
+            _mm512_set_epi64(7 * stride, 6 * stride, 5 * stride, 4 * stride,
+                             3 * stride, 2 * stride, stride, 0);
+    const __m512d one = _mm512_set1_pd(1.0);
+    const __m512d zero = _mm512_setzero_pd();
+
+    std::size_t i = begin;
+    for (; i + 8 <= count; i += 8) {
+        const __m512d x = load8(in.rotationX, in.stride, i, offsets);
+        const __m512d y = load8(in.rotationY, in.stride, i, offsets);
+        const __m512d z = load8(in.rotationZ, in.stride, i, offsets);
+        const __m512d w = load8(in.rotationW, in.stride, i, offsets);
+        const __m512d s = load8(in.scale, in.stride, i, offsets);
+
+        const __m512d x2 = _mm512_add_pd(x, x);
+        const __m512d y2 = _mm512_add_pd(y, y);
+        const __m512d z2 = _mm512_add_pd(z, z);
+        const __m512d xx = _mm512_mul_pd(x, x2);
+        const __m512d yy = _mm512_mul_pd(y, y2);
+        const __m512d zz = _mm512_mul_pd(z, z2);
+        const __m512d xy = _mm512_mul_pd(x, y2);
+        const __m512d xz = _mm512_mul_pd(x, z2);
+        const __m512d yz = _mm512_mul_pd(y, z2);
+        const __m512d wx = _mm512_mul_pd(w, x2);
+        const __m512d wy = _mm512_mul_pd(w, y2);
+        const __m512d wz = _mm512_mul_pd(w, z2);
+
+        double *m = out + i * outStride;
+        storeColumn8(
+                m, outStride, 0,
+                _mm512_mul_pd(_mm512_sub_pd(one, _mm512_add_pd(yy, zz)), s),
+                _mm512_mul_pd(_mm512_add_pd(xy, wz), s),
+                _mm512_mul_pd(_mm512_sub_pd(xz, wy), s), zero);
+        storeColumn8(
+                m, outStride, 1, _mm512_mul_pd(_mm512_sub_pd(xy, wz), s),
+                _mm512_mul_pd(_mm512_sub_pd(one, _mm512_add_pd(xx, zz)), s),
+                _mm512_mul_pd(_mm512_add_pd(yz, wx), s), zero);
+        storeColumn8(
+                m, outStride, 2, _mm512_mul_pd(_mm512_add_pd(xz, wy), s),
+                _mm512_mul_pd(_mm512_sub_pd(yz, wx), s),
+                _mm512_mul_pd(_mm512_sub_pd(one, _mm512_add_pd(xx, yy)), s),
+                zero);
+        storeColumn8(m, outStride, 3,
+                     load8(in.positionX, in.stride, i, offsets),
+                     load8(in.positionY, in.stride, i, offsets),
+                     load8(in.positionZ, in.stride, i, offsets), one);
+    }
+    return i;
+}
+#endif
+
+TransformIsa detectTransformIsa() {
+#if defined(TRANSFORM_KERNEL_X86)
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return TransformIsa::Avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return TransformIsa::Avx2;
+    }
+#else
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return TransformIsa::Scalar;
+    }
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) {
+        return TransformIsa::Scalar;
+    }
+    // the OS has to save the vector registers on context switches
+    const unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    if ((info[1] & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6) {
+        return TransformIsa::Avx512;
+    }
+    if ((info[1] & (1 << 5)) != 0 && (xcr0 & 0x6) == 0x6) {
+        return TransformIsa::Avx2;
+    }
+#endif
+#endif
+    return TransformIsa::Scalar;
+}
+}  // namespace
+
+TransformIsa supportedTransformIsa() {
+    static const TransformIsa isa = detectTransformIsa();
+    return isa;
+}
+
+void composeTrs(const TrsStreams &in, double *out, std::size_t outStride,
+                std::size_t count) {
+    composeTrs(supportedTransformIsa(), in, out, outStride, count);
+}
+
+void composeTrs([[maybe_unused]] TransformIsa isa, const TrsStreams &in,
+                double *out, std::size_t outStride, std::size_t count) {
+    std::size_t done = 0;
+#if defined(TRANSFORM_KERNEL_X86)
+    switch (isa) {
+        case TransformIsa::Avx512:
+            done = composeAvx512(in, out, outStride, 0, count);
+            // the last 4 to 7 transforms still fit an AVX2 iteration
+            done = composeAvx2(in, out, outStride, done, count);
+            break;
+        case TransformIsa::Avx2:
+            done = composeAvx2(in, out, outStride, 0, count);
+            break;
+        case TransformIsa::Scalar:
+            break;
+    }
+#endif
+    composeScalar(in, out, outStride, done, count);
+}
+
+bool isUniformTrs(const double *m, double tolerance) {
+    if (m[3] != 0.0 || m[7] != 0.0 || m[11] != 0.0 || m[15] != 1.0) {
+        return false;
+    }
+    const auto dot = [m](int a, int b) {
+        return m[a * 4] * m[b * 4] + m[a * 4 + 1] * m[b * 4 + 1] +
+               m[a * 4 + 2] * m[b * 4 + 2];
+    };
+    const double scale2 = dot(0, 0);
+    if (!(scale2 > 0.0) || !std::isfinite(scale2)) {
+        return false;
+    }
+    const double limit = tolerance * scale2;
+    return std::abs(dot(1, 1) - scale2) <= limit &&
+           std::abs(dot(2, 2) - scale2) <= limit &&
+           std::abs(dot(0, 1)) <= limit && std::abs(dot(0, 2)) <= limit &&
+           std::abs(dot(1, 2)) <= limit;
+}
+
+void relativeTrs(const double *parents, std::size_t parentStride,
+                 const double *globals, std::size_t globalStride,
+                 const TrsOutputStreams &out, std::size_t count) {
+    for (std::size_t i = 0; i < count; i++) {
+        const double *p = parents + i * parentStride;
+        const double *g = globals + i * globalStride;
+
+        // rows of inverse(parent) are the parent's columns / scale^2
+        const double invScale2 =
+                1.0 / (p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+        const auto apply = [p, invScale2](double x, double y, double z,
+                                          int row) {
+            return (p[row * 4] * x + p[row * 4 + 1] * y + p[row * 4 + 2] * z) *
+                   invScale2;
+        };
+
+        // l[c * 3 + r]: column c, row r of the local linear part
+        double l[9];
+        for (int c = 0; c < 3; c++) {
+            for (int r = 0; r < 3; r++) {
+                l[c * 3 + r] = apply(g[c * 4], g[c * 4 + 1], g[c * 4 + 2], r);
+            }
+        }
+        const double dx = g[12] - p[12];
+        const double dy = g[13] - p[13];
+        const double dz = g[14] - p[14];
+
+        const double scale =
+                std::sqrt(l[0] * l[0] + l[1] * l[1] + l[2] * l[2]);
+        const double invScale = 1.0 / scale;
+        for (double &value : l) {
+            value *= invScale;
+        }
+
+        // largest of 4w^2, 4x^2, 4y^2, 4z^2 - 1 keeps the division stable
+        const double fourW = l[0] + l[4] + l[8];
+        const double fourX = l[0] - l[4] - l[8];
+        const double fourY = l[4] - l[0] - l[8];
+        const double fourZ = l[8] - l[0] - l[4];
+        double w, x, y, z;
+        if (fourW >= fourX && fourW >= fourY && fourW >= fourZ) {
+            w = std::sqrt(fourW + 1.0) * 0.5;
+            const double mult = 0.25 / w;
+            x = (l[5] - l[7]) * mult;
+            y = (l[6] - l[2]) * mult;
+            z = (l[1] - l[3]) * mult;
+        } else if (fourX >= fourY && fourX >= fourZ) {
+            x = std::sqrt(fourX + 1.0) * 0.5;
+            const double mult = 0.25 / x;
+            w = (l[5] - l[7]) * mult;
+            y = (l[1] + l[3]) * mult;
+            z = (l[6] + l[2]) * mult;
+        } else if (fourY >= fourZ) {
+            y = std::sqrt(fourY + 1.0) * 0.5;
+            const double mult = 0.25 / y;
+            w = (l[6] - l[2]) * mult;
+            x = (l[1] + l[3]) * mult;
+            z = (l[5] + l[7]) * mult;
+        } else {
+            z = std::sqrt(fourZ + 1.0) * 0.5;
+            const double mult = 0.25 / z;
+            w = (l[1] - l[3]) * mult;
+            x = (l[6] + l[2]) * mult;
+            y = (l[5] + l[7]) * mult;
+        }
+
+        const std::size_t j = i * out.stride;
+        out.positionX[j] = apply(dx, dy, dz, 0);
+        out.positionY[j] = apply(dx, dy, dz, 1);
+        out.positionZ[j] = apply(dx, dy, dz, 2);
+        out.rotationX[j] = x;
+        out.rotationY[j] = y;
+        out.rotationZ[j] = z;
+        out.rotationW[j] = w;
+        out.scale[j] = scale;
+    }
+}
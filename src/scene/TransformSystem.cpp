@@ -1,84 +1,195 @@
 #include "scene/TransformSystem.h"
 
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <utility>
+#include <vector>
+
 #include "glm/gtx/matrix_decompose.hpp"
+#include "core/JobSystem.h"
 #include "scene/ParentSystem.h"
+#include "scene/TransformKernel.h"
 
 namespace {
-void UpdateChildrenGlobal(flecs::entity e, const GlobalTransform &t) {
-    if (e.has<Child>()) {
-        auto c = e.get<Child>();
-        for (auto &child : c->children) {
-            auto *child_transform = child.get<LocalTransform>();
-            auto *child_global_transform = child.get_mut<GlobalTransform>();
-            child_global_transform->TransformMatrix =
-                    t.TransformMatrix *
-                    glm::translate(glm::f64mat4(1.0),
-                                   child_transform->position) *
-                    glm::mat4_cast(child_transform->rotation) *
-                    glm::scale(glm::f64mat4(1.0),
-                               glm::f64vec3(child_transform->scale));
-        }
+static_assert(sizeof(LocalTransform) % sizeof(double) == 0);
+static_assert(sizeof(GlobalTransform) == 16 * sizeof(double));
+
+TrsStreams localTransformStreams(const LocalTransform *locals) {
+    return {
+            .positionX = &locals->position.x,
+            .positionY = &locals->position.y,
+            .positionZ = &locals->position.z,
+            .rotationX = &locals->rotation.x,
+            .rotationY = &locals->rotation.y,
+            .rotationZ = &locals->rotation.z,
+            .rotationW = &locals->rotation.w,
+            .scale = &locals->scale,
+            .stride = sizeof(LocalTransform) / sizeof(double),
+    };
+}
+
+glm::f64mat4 parentGlobalMatrix(flecs::entity parent) {
+    if (parent.is_alive() && parent.has<GlobalTransform>()) {
+        return parent.get<GlobalTransform>()->TransformMatrix;
     }
+    return glm::f64mat4(1.0);
+}
+
+TrsOutputStreams localTransformOutputs(LocalTransform *locals) {
+    return {
+            .positionX = &locals->position.x,
+            .positionY = &locals->position.y,
+            .positionZ = &locals->position.z,
+            .rotationX = &locals->rotation.x,
+            .rotationY = &locals->rotation.y,
+            .rotationZ = &locals->rotation.z,
+            .rotationW = &locals->rotation.w,
+            .scale = &locals->scale,
+            .stride = sizeof(LocalTransform) / sizeof(double),
+    };
+}
+
+// for parents or globals with skew or non uniform scale
+LocalTransform localFromGlobalGeneric(const glm::f64mat4 &parentGlobal,
+                                      const glm::f64mat4 &global) {
+    glm::f64vec3 position;
+    glm::f64quat rotation;
+    glm::f64vec3 scale;
+    glm::f64vec3 skew;
+    glm::f64vec4 perspective;
+    glm::decompose(glm::inverse(parentGlobal) * global, scale, rotation,
+                   position, skew, perspective);
+    return {position, rotation, scale.x};
+}
+
+void setLocalFromGlobal(flecs::entity e, const glm::f64mat4 &parentGlobal,
+                        const glm::f64mat4 &global) {
+    *e.get_mut<LocalTransform>() = localFromGlobal(parentGlobal, global);
 }
 
 void CreateChildLocalIfParentSet(flecs::entity e, const Parent &p) {
     if (e.has<GlobalTransform>()) {
-        const auto t = e.get<GlobalTransform>();
-        const auto local =
-                t->TransformMatrix *
-                glm::inverse(p.parent.get<GlobalTransform>()->TransformMatrix);
-        glm::f64vec3 position;
-        glm::f64quat rotation;
-        glm::f64vec3 scale;
-        glm::f64vec3 skew;
-        glm::f64vec4 perspective;
-        glm::decompose(local, scale, rotation, position, skew, perspective);
-        e.set(LocalTransform{position, rotation, scale.x});
+        e.set(localFromGlobal(parentGlobalMatrix(p.parent),
+                              e.get<GlobalTransform>()->TransformMatrix));
     }
 }
 
 void UpdateChildLocalIfParentChanged(flecs::entity e, const Parent &p) {
-    const auto t = e.get<GlobalTransform>();
-    const auto local =
-            t->TransformMatrix *
-            glm::inverse(p.parent.get<GlobalTransform>()->TransformMatrix);
-    glm::f64vec3 position;
-    glm::f64quat rotation;
-    glm::f64vec3 scale;
-    glm::f64vec3 skew;
-    glm::f64vec4 perspective;
-    glm::decompose(local, scale, rotation, position, skew, perspective);
-    auto *transform = e.get_mut<LocalTransform>();
-    transform->position = position;
-    transform->rotation = rotation;
-    transform->scale = scale.x;
-}
-
-void UpdateChildLocalIfGlobalChanged(flecs::entity e,
-                                     const GlobalTransform &t) {
-    if (e.has<Parent>()) {
-        const auto p = e.get<Parent>();
-        const auto local =
-                t.TransformMatrix *
-                glm::inverse(p->parent.get<GlobalTransform>()->TransformMatrix);
-        glm::f64vec3 position;
-        glm::f64quat rotation;
-        glm::f64vec3 scale;
-        glm::f64vec3 skew;
-        glm::f64vec4 perspective;
-        glm::decompose(local, scale, rotation, position, skew, perspective);
-        auto *transform = e.get_mut<LocalTransform>();
-        transform->position = position;
-        transform->rotation = rotation;
-        transform->scale = scale.x;
-    }
-}
-
-void UpdateChildGlobalIfLocalChanged(flecs::entity e, const LocalTransform &t) {
-    [[maybe_unused]] auto global = e.get_mut<GlobalTransform>()
-                                           ->TransformMatrix =
-            getMatrixFromLocal(t) *
-            e.get<Parent>()->parent.get<GlobalTransform>()->TransformMatrix;
+    if (!e.has<GlobalTransform>() || !e.has<LocalTransform>()) {
+        return;
+    }
+    setLocalFromGlobal(e, parentGlobalMatrix(p.parent),
+                       e.get<GlobalTransform>()->TransformMatrix);
+    markTransformDirty(e);
+}
+
+// keeps the local coordinates in sync when the global ones are written
+// directly. Roots treat their local coordinates as global ones.
+void UpdateLocalIfGlobalChanged(flecs::entity e, const GlobalTransform &t) {
+    if (e.has<LocalTransform>()) {
+        const glm::f64mat4 parent =
+                e.has<Parent>() ? parentGlobalMatrix(e.get<Parent>()->parent)
+                                : glm::f64mat4(1.0);
+        setLocalFromGlobal(e, parent, t.TransformMatrix);
+    }
+    markTransformDirty(e);
+}
+
+void MarkDirtyIfLocalChanged(flecs::entity e, const LocalTransform &) {
+    markTransformDirty(e);
+}
+
+// a dirty entity is a root of the pass unless one of its ancestors is dirty
+// too, in which case it is reached while walking down from that ancestor.
+// dirty is sorted.
+bool isDirtyRoot(flecs::entity e, const std::vector<flecs::entity_t> &dirty) {
+    while (e.has<Parent>()) {
+        e = e.get<Parent>()->parent;
+        if (!e.is_alive()) {
+            break;
+        }
+        if (std::ranges::binary_search(dirty, e.id())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// An entity of the level being walked, with the matrix computed for its
+// parent by this pass, or null for the roots of the pass.
+struct LevelEntry {
+    flecs::entity entity;
+    const glm::f64mat4 *parentGlobal;
+};
+
+// Entities still lacking a GlobalTransform, with the matrix computed for
+// them. A deque keeps the matrices in place while their children read them.
+using MissingGlobals = std::deque<std::pair<flecs::entity, glm::f64mat4>>;
+
+const glm::f64mat4 kIdentity(1.0);
+
+// Only reads the world and writes e's own GlobalTransform in place, so
+// entities of the same level can be updated from several threads. Returns
+// where e's matrix is for its children to read. The children never read
+// the component of their parent, whose GlobalTransform may only be added
+// once the pass ends, as adding a component is not thread safe and is
+// deferred while systems run.
+const glm::f64mat4 *updateGlobal(flecs::entity e,
+                                 const glm::f64mat4 *parentGlobal,
+                                 MissingGlobals &missing) {
+    GlobalTransform *global = e.get_mut<GlobalTransform>();
+    if (!e.has<LocalTransform>()) {
+        return global != nullptr ? &global->TransformMatrix : &kIdentity;
+    }
+    // composed in batches before the walk
+    if (global != nullptr && !e.has<Parent>()) {
+        return &global->TransformMatrix;
+    }
+    glm::f64mat4 matrix = getMatrixFromLocal(*e.get<LocalTransform>());
+    if (parentGlobal != nullptr) {
+        matrix = *parentGlobal * matrix;
+    } else if (e.has<Parent>()) {
+        // the parent of a root of the pass is not dirty, its component is
+        // up to date
+        matrix = parentGlobalMatrix(e.get<Parent>()->parent) * matrix;
+    }
+    // get_mut does not emit OnSet, so this does not mark e dirty again
+    if (global != nullptr) {
+        global->TransformMatrix = matrix;
+        return &global->TransformMatrix;
+    }
+    return &missing.emplace_back(e, matrix).second;
+}
+
+// runs fn(begin, end, slot) on the jobs, or inline on slot 0 without them
+void forEachChunk(
+        JobSystem *jobs, std::size_t count, std::size_t grain,
+        const std::function<void(std::size_t, std::size_t, unsigned)> &fn) {
+    if (jobs != nullptr) {
+        jobs->parallel_for(count, grain, fn);
+    } else if (count > 0) {
+        fn(0, count, 0);
+    }
+}
+
+// below this many entities per chunk, waking workers costs more than it saves
+constexpr std::size_t kPropagationGrain = 512;
+
+// parentless roots of the pass, gathered for the vector kernel
+struct RootBatch {
+    std::vector<LocalTransform> locals;
+    std::vector<GlobalTransform> composed;
+    std::vector<GlobalTransform *> targets;
+};
+
+// TransformSystem() creates the singleton while the world is not deferred, a
+// pass driven by hand creates it on its first call
+TransformChanges &transformChanges(flecs::world world) {
+    if (auto *changes = world.get_mut<TransformChanges>()) {
+        return *changes;
+    }
+    return world.ensure<TransformChanges>();
 }
 }  // namespace
 
@@ -136,16 +247,48 @@ glm::f64mat4 getMatrixFromLocal(flecs::entity e) {
         return glm::f64mat4(1.0);
     }
 #endif
-    const auto *transform = e.get_mut<LocalTransform>();
-    return glm::translate(glm::f64mat4(1.0), transform->position) *
-           glm::mat4_cast(transform->rotation) *
-           glm::scale(glm::f64mat4(1.0), glm::f64vec3(transform->scale));
+    return getMatrixFromLocal(*e.get<LocalTransform>());
 }
 
 glm::f64mat4 getMatrixFromLocal(const LocalTransform &t) {
-    return glm::translate(glm::f64mat4(1.0), t.position) *
-           glm::mat4_cast(t.rotation) *
-           glm::scale(glm::f64mat4(1.0), glm::f64vec3(t.scale));
+    glm::f64mat4 matrix;
+    composeTrs(TransformIsa::Scalar, localTransformStreams(&t), &matrix[0][0],
+               16, 1);
+    return matrix;
+}
+
+void composeLocalMatrices(const LocalTransform *locals, GlobalTransform *out,
+                          std::size_t count) {
+    composeTrs(localTransformStreams(locals), &out->TransformMatrix[0][0],
+               sizeof(GlobalTransform) / sizeof(double), count);
+}
+
+LocalTransform localFromGlobal(const glm::f64mat4 &parentGlobal,
+                               const glm::f64mat4 &global) {
+    if (!isUniformTrs(&parentGlobal[0][0]) || !isUniformTrs(&global[0][0])) {
+        return localFromGlobalGeneric(parentGlobal, global);
+    }
+    LocalTransform local;
+    relativeTrs(&parentGlobal[0][0], 16, &global[0][0], 16,
+                localTransformOutputs(&local), 1);
+    return local;
+}
+
+void localsFromGlobals(const glm::f64mat4 *parentGlobals,
+                       const glm::f64mat4 *globals, LocalTransform *out,
+                       std::size_t count) {
+    if (count == 0) {
+        return;
+    }
+    relativeTrs(&parentGlobals[0][0][0], 16, &globals[0][0][0], 16,
+                localTransformOutputs(out), count);
+    // rare enough that redoing them beats splitting the batch
+    for (std::size_t i = 0; i < count; i++) {
+        if (!isUniformTrs(&parentGlobals[i][0][0]) ||
+            !isUniformTrs(&globals[i][0][0])) {
+            out[i] = localFromGlobalGeneric(parentGlobals[i], globals[i]);
+        }
+    }
 }
 
 void localRotate(flecs::entity e, const glm::f64quat &rot) {
@@ -355,20 +498,141 @@ void inverseGlobal(flecs::entity e) {
     transform->TransformMatrix = glm::inverse(transform->TransformMatrix);
 }
 
-void TransformSystem(const flecs::world &world) {
-    world.system<GlobalTransform>("UpdateChildrenGlobal")
-            .kind(flecs::OnSet)
-            .each(UpdateChildrenGlobal);
+void markTransformDirty(flecs::entity e) {
+    transformChanges(e.world()).dirty.push_back(e.id());
+}
+
+TransformPropagationStats propagateTransforms(flecs::world &world,
+                                              JobSystem *jobs) {
+    TransformPropagationStats stats{};
+    TransformChanges &changes = transformChanges(world);
+
+    // whatever consumed the previous pass's changes has run by now
+    changes.changed.clear();
+
+    // sorted without repeats, for isDirtyRoot()
+    std::vector<flecs::entity_t> dirty;
+    dirty.swap(changes.dirty);
+    std::ranges::sort(dirty);
+    const auto repeated = std::ranges::unique(dirty);
+    dirty.erase(repeated.begin(), repeated.end());
+    std::erase_if(dirty, [&world](const flecs::entity_t id) {
+        return !world.is_alive(id);
+    });
+    if (dirty.empty()) {
+        return stats;
+    }
+
+    // per thread output, merged once every thread is done with a step
+    const unsigned slots = jobs != nullptr ? jobs->thread_count() : 1;
+    std::vector<std::vector<LevelEntry>> found(slots);
+    std::vector<MissingGlobals> missing(slots);
+    std::vector<RootBatch> batches(slots);
+    std::vector<LevelEntry> level;
+    const auto gather = [&found, &level] {
+        level.clear();
+        for (std::vector<LevelEntry> &part : found) {
+            level.insert(level.end(), part.begin(), part.end());
+            part.clear();
+        }
+    };
+
+    forEachChunk(jobs, dirty.size(), kPropagationGrain,
+                 [&](std::size_t begin, std::size_t end, unsigned slot) {
+                     for (std::size_t i = begin; i < end; i++) {
+                         const flecs::entity e = world.entity(dirty[i]);
+                         if (isDirtyRoot(e, dirty)) {
+                             found[slot].push_back({e, nullptr});
+                         }
+                     }
+                 });
+    gather();
+    stats.dirtyRoots = static_cast<uint32_t>(level.size());
+
+    // parentless roots need no parent matrix, so they go through the vector
+    // kernel in batches
+    forEachChunk(jobs, level.size(), kPropagationGrain,
+                 [&](std::size_t begin, std::size_t end, unsigned slot) {
+                     RootBatch &batch = batches[slot];
+                     batch.locals.clear();
+                     batch.targets.clear();
+                     for (std::size_t i = begin; i < end; i++) {
+                         const flecs::entity e = level[i].entity;
+                         if (e.has<Parent>() || !e.has<LocalTransform>()) {
+                             continue;
+                         }
+                         if (auto *global = e.get_mut<GlobalTransform>()) {
+                             batch.locals.push_back(*e.get<LocalTransform>());
+                             batch.targets.push_back(global);
+                         }
+                     }
+                     batch.composed.resize(batch.locals.size());
+                     composeLocalMatrices(batch.locals.data(),
+                                          batch.composed.data(),
+                                          batch.locals.size());
+                     for (std::size_t j = 0; j < batch.targets.size(); j++) {
+                         batch.targets[j]->TransformMatrix =
+                                 batch.composed[j].TransformMatrix;
+                     }
+                 });
+
+    // parents are always a level above their children, so every global
+    // matrix is read after it has been written for this frame, and entities
+    // of one level never write anything another one reads
+    while (!level.empty()) {
+        forEachChunk(
+                jobs, level.size(), kPropagationGrain,
+                [&](std::size_t begin, std::size_t end, unsigned slot) {
+                    for (std::size_t i = begin; i < end; i++) {
+                        const LevelEntry &entry = level[i];
+                        const glm::f64mat4 *global = updateGlobal(
+                                entry.entity, entry.parentGlobal,
+                                missing[slot]);
+                        forEachChild(entry.entity, [&](flecs::entity child) {
+                            found[slot].push_back({child, global});
+                        });
+                    }
+                });
+        stats.updatedEntities += static_cast<uint32_t>(level.size());
+        stats.depth++;
+        for (const LevelEntry &entry : level) {
+            changes.changed.push_back(entry.entity.id());
+        }
+        gather();
+    }
+
+    // added once the walk ends, the children hold pointers into the columns
+    // of their parents. ensure, unlike set, does not emit OnSet, which would
+    // recompute the local coordinates from the matrix and mark the entity
+    // dirty again
+    for (const MissingGlobals &part : missing) {
+        for (const auto &[e, matrix] : part) {
+            e.ensure<GlobalTransform>().TransformMatrix = matrix;
+        }
+    }
+    return stats;
+}
+
+void TransformSystem(flecs::world &world, JobSystem *jobs) {
     world.system<Parent>("CreateChildLocalIfParentSet")
             .kind(flecs::OnAdd)
             .each(CreateChildLocalIfParentSet);
     world.system<Parent>("UpdateChildLocalIfParentChanged")
             .kind(flecs::OnSet)
             .each(UpdateChildLocalIfParentChanged);
-    world.system<GlobalTransform>("UpdateChildLocalIfGlobalChanged")
+    world.system<GlobalTransform>("UpdateLocalIfGlobalChanged")
             .kind(flecs::OnSet)
-            .each(UpdateChildLocalIfGlobalChanged);
-    world.system<LocalTransform>("UpdateChildGlobalIfLocalChanged")
+            .each(UpdateLocalIfGlobalChanged);
+    world.system<LocalTransform>("MarkDirtyIfLocalChanged")
             .kind(flecs::OnSet)
-            .each(UpdateChildGlobalIfLocalChanged);
-}
\ No newline at end of file
+            .each(MarkDirtyIfLocalChanged);
+
+    world.add<TransformChanges>();
+    world.set<TransformPropagationStats>({});
+    world.system("PropagateTransforms")
+            .kind(flecs::PostUpdate)
+            .run([jobs](flecs::iter &it) {
+                flecs::world w = it.world();
+                w.set<TransformPropagationStats>(propagateTransforms(w, jobs));
+            });
+}
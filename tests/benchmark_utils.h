@@ -0,0 +1,24 @@
+#pragma once
+
+#include <chrono>
+#include <iostream>
+
+// Timing and reporting shared by the benchmarks.
+
+template <typename Fn>
+double measureMs(Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+// prints both timings of one operation and how much faster the candidate is
+inline void report(const char* what, const char* baselineName,
+                   double baselineMs, const char* candidateName,
+                   double candidateMs) {
+    std::cout << what << ": " << baselineName << " " << baselineMs << " ms, "
+              << candidateName << " " << candidateMs << " ms (x"
+              << baselineMs / candidateMs << ")\n";
+}
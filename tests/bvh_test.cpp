@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "scene/Bvh.h"
+
+// Checks every BVH query against a brute force scan of the same boxes, as
+// the tree is built, moved, refitted and emptied.
+
+namespace {
+constexpr int kBoxCount = 5'000;
+constexpr int kQueryCount = 50;
+
+struct Reference {
+    std::vector<Aabb> boxes;
+    std::vector<bool> alive;
+};
+
+Aabb randomBox(std::mt19937_64& generator) {
+    std::uniform_real_distribution<double> position(-1000.0, 1000.0);
+    std::uniform_real_distribution<double> size(0.1, 20.0);
+    const glm::dvec3 min(position(generator), position(generator),
+                         position(generator));
+    return {min, min + glm::dvec3(size(generator), size(generator),
+                                  size(generator))};
+}
+
+double squaredDistance(const Aabb& box, const glm::dvec3& point) {
+    double sum = 0.0;
+    for (int i = 0; i < 3; i++) {
+        const double d = std::max({box.min[i] - point[i],
+                                   point[i] - box.max[i], 0.0});
+        sum += d * d;
+    }
+    return sum;
+}
+
+std::vector<uint64_t> sorted(std::vector<uint64_t> ids) {
+    std::ranges::sort(ids);
+    return ids;
+}
+
+// an axis aligned box seen as a frustum, planes pointing inwards
+std::array<glm::dvec4, 6> boxPlanes(const Aabb& box) {
+    return {glm::dvec4(1, 0, 0, -box.min.x), glm::dvec4(-1, 0, 0, box.max.x),
+            glm::dvec4(0, 1, 0, -box.min.y), glm::dvec4(0, -1, 0, box.max.y),
+            glm::dvec4(0, 0, 1, -box.min.z), glm::dvec4(0, 0, -1, box.max.z)};
+}
+
+void expectQueriesMatch(const Bvh& bvh, const Reference& reference,
+                        std::mt19937_64& generator) {
+    std::uniform_real_distribution<double> position(-1000.0, 1000.0);
+    std::uniform_real_distribution<double> radius(1.0, 300.0);
+    std::uniform_int_distribution<std::size_t> k(1, 20);
+
+    for (int q = 0; q < kQueryCount; q++) {
+        const glm::dvec3 center(position(generator), position(generator),
+                                position(generator));
+        const double r = radius(generator);
+        const Aabb region{center - r, center + r};
+
+        std::vector<uint64_t> expectedBox;
+        std::vector<uint64_t> expectedSphere;
+        std::vector<std::pair<double, uint64_t>> distances;
+        for (uint64_t id = 0; id < reference.boxes.size(); id++) {
+            if (!reference.alive[id]) {
+                continue;
+            }
+            const Aabb& box = reference.boxes[id];
+            if (box.overlaps(region)) {
+                expectedBox.push_back(id);
+            }
+            const double d = squaredDistance(box, center);
+            if (d <= r * r) {
+                expectedSphere.push_back(id);
+            }
+            distances.emplace_back(d, id);
+        }
+
+        std::vector<uint64_t> actual;
+        bvh.queryAabb(region, actual);
+        EXPECT_EQ(sorted(actual), expectedBox);
+
+        actual.clear();
+        bvh.queryFrustum(boxPlanes(region), actual);
+        EXPECT_EQ(sorted(actual), expectedBox);
+
+        actual.clear();
+        bvh.querySphere(center, r, actual);
+        EXPECT_EQ(sorted(actual), expectedSphere);
+
+        // ties make the ids ambiguous, the distances are not
+        const std::size_t count = std::min(k(generator), distances.size());
+        std::ranges::sort(distances);
+        bvh.nearest(center, count, actual);
+        ASSERT_EQ(actual.size(), count);
+        for (std::size_t i = 0; i < count; i++) {
+            EXPECT_EQ(squaredDistance(reference.boxes[actual[i]], center),
+                      distances[i].first);
+        }
+    }
+}
+}  // namespace
+
+TEST(BvhTest, QueriesMatchBruteForce) {
+    std::mt19937_64 generator(7);
+    Bvh bvh;
+    Reference reference;
+    std::vector<Bvh::Proxy> proxies;
+
+    for (uint64_t id = 0; id < kBoxCount; id++) {
+        reference.boxes.push_back(randomBox(generator));
+        reference.alive.push_back(true);
+        proxies.push_back(bvh.insert(id, reference.boxes.back()));
+    }
+    EXPECT_EQ(bvh.size(), static_cast<std::size_t>(kBoxCount));
+    expectQueriesMatch(bvh, reference, generator);
+
+    // the first refit establishes the surface area heuristic baseline
+    EXPECT_TRUE(bvh.refit());
+    expectQueriesMatch(bvh, reference, generator);
+
+    // small moves are absorbed by refitting
+    std::normal_distribution<double> jitter(0.0, 1.0);
+    for (int frame = 0; frame < 5; frame++) {
+        for (uint64_t id = 0; id < kBoxCount; id += 10) {
+            const glm::dvec3 offset(jitter(generator), jitter(generator),
+                                    jitter(generator));
+            Aabb& box = reference.boxes[id];
+            box = {box.min + offset, box.max + offset};
+            bvh.update(proxies[id], box);
+        }
+        EXPECT_FALSE(bvh.refit());
+        expectQueriesMatch(bvh, reference, generator);
+    }
+
+    // teleporting everything ruins the tree until the next rebuild
+    for (uint64_t id = 0; id < kBoxCount; id++) {
+        reference.boxes[id] = randomBox(generator);
+        bvh.update(proxies[id], reference.boxes[id]);
+    }
+    EXPECT_TRUE(bvh.refit());
+    expectQueriesMatch(bvh, reference, generator);
+
+    for (uint64_t id = 0; id < kBoxCount; id += 2) {
+        bvh.remove(proxies[id]);
+        reference.alive[id] = false;
+    }
+    bvh.refit();
+    EXPECT_EQ(bvh.size(), static_cast<std::size_t>(kBoxCount / 2));
+    expectQueriesMatch(bvh, reference, generator);
+
+    // proxies survive a rebuild
+    bvh.rebuild();
+    for (uint64_t id = 1; id < kBoxCount; id += 2) {
+        EXPECT_EQ(bvh.id(proxies[id]), id);
+    }
+    expectQueriesMatch(bvh, reference, generator);
+
+    for (uint64_t id = 1; id < kBoxCount; id += 2) {
+        bvh.remove(proxies[id]);
+    }
+    EXPECT_TRUE(bvh.empty());
+    std::vector<uint64_t> none;
+    bvh.nearest(glm::dvec3(0.0), 3, none);
+    EXPECT_TRUE(none.empty());
+}
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/trigonometric.hpp>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "core/JobSystem.h"
+#include "graphics/vulkan/vk_draw_list.h"
+#include "graphics/vulkan/vk_draw_sort.h"
+#include "graphics/vulkan/vk_engine.h"
+
+// Scaling of culling and sort key assignment over thread counts, for 200k
+// surfaces scattered around a camera that sees a fraction of them.
+
+namespace {
+constexpr std::size_t kSurfaceCount = 200'000;
+constexpr int kMaterialCount = 64;
+constexpr int kFrames = 20;
+constexpr float kFarPlane = 2000.f;
+
+struct Scene {
+    MaterialPipeline pipeline;
+    std::vector<MaterialInstance> materials;
+    std::vector<RenderObject> objects;
+};
+
+// only the values the sort keys read are meaningful, nothing is recorded
+void createScene(Scene& scene) {
+    std::mt19937 generator(3);
+    std::uniform_real_distribution<float> position(-1000.f, 1000.f);
+    std::uniform_int_distribution<int> material(0, kMaterialCount - 1);
+
+    scene.pipeline = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+    for (int i = 0; i < kMaterialCount; i++) {
+        scene.materials.push_back({&scene.pipeline,
+                                   static_cast<uint32_t>(i),
+                                   MaterialPass::MainColor});
+    }
+
+    scene.objects.resize(kSurfaceCount);
+    for (std::size_t i = 0; i < kSurfaceCount; i++) {
+        RenderObject& object = scene.objects[i];
+        object.indexCount = 36;
+        object.firstIndex = static_cast<uint32_t>(i % 128) * 36;
+        object.material = &scene.materials[material(generator)];
+        object.bounds = {glm::vec3(0.f), 1.7f, glm::vec3(1.f)};
+        object.transform = glm::translate(
+                glm::mat4(1.f), glm::vec3(position(generator),
+                                          position(generator),
+                                          position(generator)));
+    }
+}
+
+// the serial path the builder replaced: one culler over every object, then
+// the keys of the visible ones, on the calling thread
+std::size_t serialCullAndSort(FrustumCuller& culler, DrawSorter& sorter,
+                              const glm::mat4& viewproj, const glm::mat4& view,
+                              std::vector<RenderObject>& objects,
+                              std::vector<uint32_t>& visible,
+                              std::vector<uint32_t>& order) {
+    visible.clear();
+    const std::size_t culled = culler.cull(Frustum::from_matrix(viewproj),
+                                           objects, 0, objects.size(), visible);
+    for (const uint32_t index : visible) {
+        assign_sort_key(view, kFarPlane, objects[index]);
+    }
+    sorter.sort_assigned(objects, visible, order);
+    return culled;
+}
+}  // namespace
+
+TEST(DrawListBenchmark, Scaling200k) {
+    Scene scene;
+    createScene(scene);
+
+    const glm::mat4 view =
+            glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f),
+                        glm::vec3(0.f, 1.f, 0.f));
+    const glm::mat4 viewproj =
+            glm::perspective(glm::radians(90.f), 16.f / 9.f, 0.1f, kFarPlane) *
+            view;
+
+    FrustumCuller culler;
+    DrawSorter sorter;
+    std::vector<uint32_t> visible;
+    std::vector<uint32_t> reference;
+    std::size_t referenceCulled = 0;
+    const double serialMs = measureMs([&] {
+        for (int frame = 0; frame < kFrames; frame++) {
+            referenceCulled = serialCullAndSort(culler, sorter, viewproj,
+                                                view, scene.objects, visible,
+                                                reference);
+        }
+    }) / kFrames;
+    std::cout << kSurfaceCount << " surfaces, serial: " << serialMs << " ms, "
+              << reference.size() << " visible\n";
+    ASSERT_GT(reference.size(), 0u);
+    ASSERT_GT(referenceCulled, 0u);
+
+    const unsigned hardwareThreads =
+            std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> threadCounts;
+    for (unsigned threads = 1; threads < hardwareThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(hardwareThreads);
+
+    double singleThreadMs = 0.0;
+    for (const unsigned threads : threadCounts) {
+        JobSystem jobs(threads);
+        DrawListBuilder builder;
+        std::vector<uint32_t> order;
+        std::size_t culled = 0;
+
+        const double ms = measureMs([&] {
+            for (int frame = 0; frame < kFrames; frame++) {
+                culled = builder.build(&jobs, viewproj, view, kFarPlane,
+                                       scene.objects, visible);
+                sorter.sort_assigned(scene.objects, visible, order);
+            }
+        }) / kFrames;
+        if (threads == 1) {
+            singleThreadMs = ms;
+        }
+
+        std::cout << kSurfaceCount << " surfaces, " << threads
+                  << " threads: " << ms << " ms (x" << singleThreadMs / ms
+                  << ", x" << serialMs / ms << " over serial)\n";
+
+        // every thread count records exactly the same draws
+        EXPECT_EQ(culled, referenceCulled);
+        EXPECT_EQ(order, reference);
+    }
+}
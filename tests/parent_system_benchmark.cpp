@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "scene/ParentSystem.h"
+
+// Compares the intrusive sibling links of the ParentSystem with the vector of
+// children it replaced, for one parent with 100k children.
+
+namespace {
+constexpr std::size_t kChildCount = 100'000;
+constexpr std::size_t kReparentCount = 10'000;
+
+// the previous representation: every parent owns a vector of its children
+struct LegacyParent {
+    flecs::entity parent;
+};
+
+struct LegacyChild {
+    std::vector<flecs::entity> children;
+};
+
+void legacyDetach(flecs::entity child) {
+    const flecs::entity parent = child.get<LegacyParent>()->parent;
+    auto &children = parent.get_mut<LegacyChild>()->children;
+    const auto newEnd = std::ranges::remove_if(
+                                children,
+                                [child](const flecs::entity &e) {
+                                    return e == child;
+                                })
+                                .begin();
+    children.erase(newEnd, children.end());
+}
+
+void legacyAttach(flecs::entity child, flecs::entity parent) {
+    if (child.has<LegacyParent>()) {
+        legacyDetach(child);
+    }
+    auto &children = parent.get_mut<LegacyChild>()->children;
+    if (std::ranges::find(children, child) == children.end()) {
+        children.push_back(child);
+    }
+    child.set<LegacyParent>({parent});
+}
+}  // namespace
+
+TEST(ParentSystemBenchmark, Children100k) {
+    flecs::world legacyWorld;
+    const flecs::entity legacyRoot = legacyWorld.entity();
+    const flecs::entity legacyOther = legacyWorld.entity();
+    legacyRoot.set<LegacyChild>({});
+    legacyOther.set<LegacyChild>({});
+    std::vector<flecs::entity> legacyChildren(kChildCount);
+    for (auto &e : legacyChildren) {
+        e = legacyWorld.entity();
+    }
+
+    flecs::world world;
+    ParentSystem(world);
+    const flecs::entity root = world.entity();
+    const flecs::entity other = world.entity();
+    std::vector<flecs::entity> children(kChildCount);
+    for (auto &e : children) {
+        e = world.entity();
+    }
+
+    const double attachVectors = measureMs([&] {
+        for (const flecs::entity e : legacyChildren) {
+            legacyAttach(e, legacyRoot);
+        }
+    });
+    const double attachLinks = measureMs([&] {
+        for (const flecs::entity e : children) {
+            setRelation(e, root);
+        }
+    });
+    report("attach 100k", "child vectors", attachVectors, "sibling links",
+           attachLinks);
+    ASSERT_EQ(legacyRoot.get<LegacyChild>()->children.size(), kChildCount);
+    ASSERT_EQ(root.get<Child>()->count, kChildCount);
+
+    // every other child of the first 20k moves, so removals hit the middle of
+    // the sibling range rather than one of its ends
+    const double reparentVectors = measureMs([&] {
+        for (std::size_t i = 0; i < kReparentCount; i++) {
+            legacyAttach(legacyChildren[i * 2], legacyOther);
+        }
+    });
+    const double reparentLinks = measureMs([&] {
+        for (std::size_t i = 0; i < kReparentCount; i++) {
+            setRelation(children[i * 2], other);
+        }
+    });
+    report("reparent 10k", "child vectors", reparentVectors, "sibling links",
+           reparentLinks);
+    ASSERT_EQ(legacyOther.get<LegacyChild>()->children.size(), kReparentCount);
+    ASSERT_EQ(other.get<Child>()->count, kReparentCount);
+    ASSERT_EQ(root.get<Child>()->count, kChildCount - kReparentCount);
+
+    std::size_t walked = 0;
+    forEachChild(root, [&](flecs::entity child) {
+        EXPECT_EQ(child.get<Parent>()->parent, root);
+        walked++;
+    });
+    EXPECT_EQ(walked, kChildCount - kReparentCount);
+
+    // the vector version deleted children one at a time, each erasing itself
+    // from its parent before the parent itself went away
+    const double destroyVectors = measureMs([&] {
+        for (const flecs::entity e : legacyChildren) {
+            if (e.get<LegacyParent>()->parent == legacyRoot) {
+                legacyDetach(e);
+                e.destruct();
+            }
+        }
+        legacyRoot.destruct();
+    });
+    const double destroyLinks = measureMs([&] { destroySubtree(root); });
+    report("destroy 90k subtree", "child vectors", destroyVectors,
+           "sibling links", destroyLinks);
+
+    EXPECT_FALSE(root.is_alive());
+    for (std::size_t i = 0; i < kChildCount; i++) {
+        // only the reparented children survive
+        EXPECT_EQ(children[i].is_alive(), i % 2 == 0 && i / 2 < kReparentCount);
+    }
+    EXPECT_EQ(other.get<Child>()->count, kReparentCount);
+}
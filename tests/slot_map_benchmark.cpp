@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "core/SlotMap.h"
+
+// Compares the slot map that stores engine mesh instances with the pair of
+// unordered_maps it replaced (one for the asset, one for the transform).
+
+namespace {
+constexpr std::size_t kInstanceCount = 100'000;
+constexpr int kFrames = 20;
+
+using Matrix = std::array<float, 16>;
+
+struct Instance {
+    Matrix transform;
+    const void* asset;
+};
+}  // namespace
+
+TEST(SlotMapBenchmark, MeshInstances100k) {
+    std::mt19937_64 generator(42);
+    std::uniform_int_distribution<int64_t> distribution;
+    // integral so that the map's hash order does not change the result
+    uint64_t checksumMaps = 0;
+    uint64_t checksumSlots = 0;
+
+    std::unordered_map<int64_t, const void*> meshes;
+    std::unordered_map<int64_t, Matrix> transforms;
+    std::vector<int64_t> keys;
+    keys.reserve(kInstanceCount);
+
+    SlotMap<Instance> instances;
+    std::vector<SlotHandle> handles;
+    handles.reserve(kInstanceCount);
+
+    const double createMaps = measureMs([&] {
+        for (std::size_t i = 0; i < kInstanceCount; i++) {
+            const int64_t key = distribution(generator);
+            meshes[key] = &keys;
+            transforms[key] = Matrix{1.f};
+            keys.push_back(key);
+        }
+    });
+    const double createSlots = measureMs([&] {
+        for (std::size_t i = 0; i < kInstanceCount; i++) {
+            handles.push_back(instances.insert({Matrix{1.f}, &handles}));
+        }
+    });
+    report("create", "unordered_maps", createMaps, "slot map", createSlots);
+
+    const double setMaps = measureMs([&] {
+        for (std::size_t i = 0; i < kInstanceCount; i++) {
+            transforms[keys[i]][12] = static_cast<float>(i);
+        }
+    });
+    const double setSlots = measureMs([&] {
+        for (std::size_t i = 0; i < kInstanceCount; i++) {
+            instances.get(handles[i])->transform[12] = static_cast<float>(i);
+        }
+    });
+    report("set transform", "unordered_maps", setMaps, "slot map", setSlots);
+
+    // the update_scene access pattern: walk the instances, read the transform
+    const double iterateMaps = measureMs([&] {
+        for (int frame = 0; frame < kFrames; frame++) {
+            for (const auto& [key, mesh] : meshes) {
+                checksumMaps += static_cast<uint64_t>(transforms[key][12]);
+            }
+        }
+    });
+    const double iterateSlots = measureMs([&] {
+        for (int frame = 0; frame < kFrames; frame++) {
+            for (const Instance& instance : instances.values()) {
+                checksumSlots +=
+                        static_cast<uint64_t>(instance.transform[12]);
+            }
+        }
+    });
+    report("iterate", "unordered_maps", iterateMaps, "slot map", iterateSlots);
+
+    const double destroyMaps = measureMs([&] {
+        for (std::size_t i = 0; i < kInstanceCount; i += 2) {
+            meshes.erase(keys[i]);
+            transforms.erase(keys[i]);
+        }
+    });
+    const double destroySlots = measureMs([&] {
+        for (std::size_t i = 0; i < kInstanceCount; i += 2) {
+            instances.erase(handles[i]);
+        }
+    });
+    report("destroy half", "unordered_maps", destroyMaps, "slot map",
+           destroySlots);
+
+    EXPECT_EQ(checksumMaps, checksumSlots);
+    EXPECT_EQ(meshes.size(), instances.size());
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "core/SlotMap.h"
+
+TEST(SlotMapTest, InsertAndGet) {
+    SlotMap<std::string> map;
+    const SlotHandle a = map.insert("a");
+    const SlotHandle b = map.insert("b");
+
+    ASSERT_NE(a, b);
+    ASSERT_NE(a, kInvalidSlotHandle);
+    EXPECT_EQ(map.size(), 2u);
+    EXPECT_EQ(*map.get(a), "a");
+    EXPECT_EQ(*map.get(b), "b");
+    EXPECT_EQ(map.get(kInvalidSlotHandle), nullptr);
+}
+
+TEST(SlotMapTest, EraseSwapsLastIntoHole) {
+    SlotMap<int> map;
+    const SlotHandle a = map.insert(1);
+    const SlotHandle b = map.insert(2);
+    const SlotHandle c = map.insert(3);
+
+    EXPECT_TRUE(map.erase(a));
+    EXPECT_FALSE(map.contains(a));
+    EXPECT_EQ(map.get(a), nullptr);
+
+    ASSERT_EQ(map.size(), 2u);
+    EXPECT_EQ(map.values()[0], 3);
+    EXPECT_EQ(map.handles()[0], c);
+    EXPECT_EQ(map.dense_index(c), 0u);
+    EXPECT_EQ(*map.get(b), 2);
+    EXPECT_EQ(*map.get(c), 3);
+}
+
+TEST(SlotMapTest, StaleHandleDoesNotResolveAfterReuse) {
+    SlotMap<int> map;
+    const SlotHandle a = map.insert(1);
+    EXPECT_TRUE(map.erase(a));
+    EXPECT_FALSE(map.erase(a));
+
+    const SlotHandle reused = map.insert(2);
+    EXPECT_NE(reused, a);
+    EXPECT_EQ(map.get(a), nullptr);
+    EXPECT_EQ(*map.get(reused), 2);
+}
+
+TEST(SlotMapTest, ClearInvalidatesHandles) {
+    SlotMap<int> map;
+    const SlotHandle a = map.insert(1);
+    const SlotHandle b = map.insert(2);
+    map.clear();
+
+    EXPECT_TRUE(map.empty());
+    EXPECT_FALSE(map.contains(a));
+    EXPECT_FALSE(map.contains(b));
+
+    const SlotHandle c = map.insert(3);
+    EXPECT_EQ(*map.get(c), 3);
+    EXPECT_EQ(map.size(), 1u);
+}
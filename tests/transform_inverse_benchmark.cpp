@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "glm/gtx/matrix_decompose.hpp"
+#include "scene/TransformSystem.h"
+
+// Time to recompute child locals from parent and child global matrices,
+// closed form against glm::inverse plus glm::decompose.
+
+namespace {
+constexpr std::size_t kPairs = 100'000;
+constexpr int kRepeats = 10;
+
+LocalTransform randomLocal(std::mt19937_64& generator) {
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    return {glm::f64vec3(unit(generator), unit(generator), unit(generator)) *
+                    100.0,
+            glm::normalize(glm::f64quat(unit(generator), unit(generator),
+                                        unit(generator), unit(generator))),
+            std::exp(unit(generator))};
+}
+}  // namespace
+
+TEST(TransformInverseBenchmark, ChildLocals100k) {
+    std::mt19937_64 generator(42);
+    std::vector<glm::f64mat4> parents;
+    std::vector<glm::f64mat4> globals;
+    parents.reserve(kPairs);
+    globals.reserve(kPairs);
+    for (std::size_t i = 0; i < kPairs; i++) {
+        parents.push_back(getMatrixFromLocal(randomLocal(generator)));
+        globals.push_back(parents.back() *
+                          getMatrixFromLocal(randomLocal(generator)));
+    }
+
+    std::vector<LocalTransform> generic(kPairs);
+    std::vector<LocalTransform> single(kPairs);
+    std::vector<LocalTransform> batched(kPairs);
+
+    const double genericMs = measureMs([&] {
+        for (int repeat = 0; repeat < kRepeats; repeat++) {
+            for (std::size_t i = 0; i < kPairs; i++) {
+                glm::f64vec3 position;
+                glm::f64quat rotation;
+                glm::f64vec3 scale;
+                glm::f64vec3 skew;
+                glm::f64vec4 perspective;
+                glm::decompose(glm::inverse(parents[i]) * globals[i], scale,
+                               rotation, position, skew, perspective);
+                generic[i] = {position, rotation, scale.x};
+            }
+        }
+    }) / kRepeats;
+    const double singleMs = measureMs([&] {
+        for (int repeat = 0; repeat < kRepeats; repeat++) {
+            for (std::size_t i = 0; i < kPairs; i++) {
+                single[i] = localFromGlobal(parents[i], globals[i]);
+            }
+        }
+    }) / kRepeats;
+    const double batchedMs = measureMs([&] {
+        for (int repeat = 0; repeat < kRepeats; repeat++) {
+            localsFromGlobals(parents.data(), globals.data(), batched.data(),
+                              kPairs);
+        }
+    }) / kRepeats;
+
+    std::cout << "inverse + decompose " << genericMs << " ms, closed form "
+              << singleMs << " ms (x" << genericMs / singleMs
+              << "), batched " << batchedMs << " ms (x"
+              << genericMs / batchedMs << ")\n";
+
+    double maxError = 0.0;
+    for (std::size_t i = 0; i < kPairs; i++) {
+        maxError = std::max(maxError,
+                            std::abs(batched[i].scale - generic[i].scale));
+        EXPECT_EQ(batched[i].scale, single[i].scale);
+    }
+    EXPECT_LT(maxError, 1e-9);
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "glm/gtx/matrix_decompose.hpp"
+#include "scene/TransformSystem.h"
+
+// Compares the closed form local recomputation with the glm::inverse and
+// glm::decompose path it replaced.
+
+namespace {
+constexpr int kSamples = 10'000;
+
+LocalTransform randomLocal(std::mt19937_64& generator) {
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    std::uniform_real_distribution<double> logScale(-3.0, 3.0);
+    const glm::f64quat rotation = glm::normalize(glm::f64quat(
+            unit(generator), unit(generator), unit(generator),
+            unit(generator)));
+    return {glm::f64vec3(unit(generator), unit(generator), unit(generator)) *
+                    1000.0,
+            rotation, std::exp(logScale(generator))};
+}
+
+LocalTransform decomposeReference(const glm::f64mat4& parentGlobal,
+                                  const glm::f64mat4& global) {
+    glm::f64vec3 position;
+    glm::f64quat rotation;
+    glm::f64vec3 scale;
+    glm::f64vec3 skew;
+    glm::f64vec4 perspective;
+    glm::decompose(glm::inverse(parentGlobal) * global, scale, rotation,
+                   position, skew, perspective);
+    return {position, rotation, scale.x};
+}
+
+// q and -q are the same rotation, so rotations are compared as matrices
+void expectNear(const LocalTransform& actual, const LocalTransform& expected) {
+    const double tolerance = 1e-9;
+    for (int i = 0; i < 3; i++) {
+        EXPECT_NEAR(actual.position[i], expected.position[i],
+                    tolerance * (1.0 + std::abs(expected.position[i])));
+    }
+    const glm::f64mat3 actualRotation = glm::mat3_cast(actual.rotation);
+    const glm::f64mat3 expectedRotation = glm::mat3_cast(expected.rotation);
+    for (int c = 0; c < 3; c++) {
+        for (int r = 0; r < 3; r++) {
+            EXPECT_NEAR(actualRotation[c][r], expectedRotation[c][r],
+                        tolerance);
+        }
+    }
+    EXPECT_NEAR(actual.scale, expected.scale, tolerance * expected.scale);
+}
+}  // namespace
+
+TEST(TransformInverseTest, MatchesInverseAndDecompose) {
+    std::mt19937_64 generator(7);
+    for (int i = 0; i < kSamples; i++) {
+        const glm::f64mat4 parent = getMatrixFromLocal(randomLocal(generator));
+        const glm::f64mat4 global =
+                parent * getMatrixFromLocal(randomLocal(generator));
+
+        expectNear(localFromGlobal(parent, global),
+                   decomposeReference(parent, global));
+    }
+}
+
+TEST(TransformInverseTest, RecoversComposedLocal) {
+    std::mt19937_64 generator(11);
+    for (int i = 0; i < kSamples; i++) {
+        const glm::f64mat4 parent = getMatrixFromLocal(randomLocal(generator));
+        const LocalTransform local = randomLocal(generator);
+
+        expectNear(localFromGlobal(parent, parent * getMatrixFromLocal(local)),
+                   local);
+    }
+}
+
+TEST(TransformInverseTest, BatchMatchesSingle) {
+    std::mt19937_64 generator(13);
+    std::vector<glm::f64mat4> parents;
+    std::vector<glm::f64mat4> globals;
+    for (int i = 0; i < 101; i++) {
+        parents.push_back(getMatrixFromLocal(randomLocal(generator)));
+        globals.push_back(parents.back() *
+                          getMatrixFromLocal(randomLocal(generator)));
+    }
+    // a sheared parent has to take the generic path
+    parents[50][1][0] = 0.5;
+
+    std::vector<LocalTransform> locals(parents.size());
+    localsFromGlobals(parents.data(), globals.data(), locals.data(),
+                      locals.size());
+
+    for (std::size_t i = 0; i < locals.size(); i++) {
+        const LocalTransform single = localFromGlobal(parents[i], globals[i]);
+        EXPECT_EQ(locals[i].position, single.position);
+        EXPECT_EQ(locals[i].rotation, single.rotation);
+        EXPECT_EQ(locals[i].scale, single.scale);
+    }
+}
+
+TEST(TransformInverseTest, NonUniformScaleFallsBack) {
+    const glm::f64mat4 parent =
+            glm::scale(glm::f64mat4(1.0), glm::f64vec3(1.0, 2.0, 3.0));
+    const glm::f64mat4 global =
+            glm::translate(glm::f64mat4(1.0), glm::f64vec3(4.0, 5.0, 6.0));
+
+    const LocalTransform local = localFromGlobal(parent, global);
+    const LocalTransform reference = decomposeReference(parent, global);
+    EXPECT_EQ(local.position, reference.position);
+    EXPECT_EQ(local.scale, reference.scale);
+}
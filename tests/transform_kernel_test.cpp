@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "scene/LocalTransformComponent.h"
+#include "scene/TransformKernel.h"
+
+// Compares every vector path of composeTrs() the CPU runs with the scalar
+// one, on structure-of-arrays input and on LocalTransform columns, for
+// counts that leave every possible tail.
+
+namespace {
+constexpr std::size_t kMaxCount = 100;
+constexpr std::size_t kMatrixStride = 16;
+// the AVX-512 path may fuse multiplies and adds, the AVX2 one does not
+constexpr double kAvx512Tolerance = 5e-16;
+
+struct SoaTransforms {
+    std::vector<double> positionX, positionY, positionZ;
+    std::vector<double> rotationX, rotationY, rotationZ, rotationW;
+    std::vector<double> scale;
+
+    [[nodiscard]] TrsStreams streams() const {
+        return {positionX.data(), positionY.data(), positionZ.data(),
+                rotationX.data(), rotationY.data(), rotationZ.data(),
+                rotationW.data(), scale.data(),     1};
+    }
+};
+
+// the same transforms as both layouts
+void randomTransforms(std::mt19937_64& generator, SoaTransforms& soa,
+                      std::vector<LocalTransform>& locals) {
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    std::uniform_real_distribution<double> scale(0.5, 1.0);
+    for (std::size_t i = 0; i < kMaxCount; i++) {
+        LocalTransform local;
+        local.position = glm::f64vec3(unit(generator), unit(generator),
+                                      unit(generator)) *
+                         1000.0;
+        local.rotation = glm::normalize(
+                glm::f64quat(unit(generator), unit(generator),
+                             unit(generator), unit(generator)));
+        local.scale = scale(generator);
+        locals.push_back(local);
+
+        soa.positionX.push_back(local.position.x);
+        soa.positionY.push_back(local.position.y);
+        soa.positionZ.push_back(local.position.z);
+        soa.rotationX.push_back(local.rotation.x);
+        soa.rotationY.push_back(local.rotation.y);
+        soa.rotationZ.push_back(local.rotation.z);
+        soa.rotationW.push_back(local.rotation.w);
+        soa.scale.push_back(local.scale);
+    }
+}
+
+// a flecs column of LocalTransform, read in place
+TrsStreams columnStreams(const std::vector<LocalTransform>& locals) {
+    const LocalTransform& first = locals.front();
+    return {&first.position.x, &first.position.y,
+            &first.position.z, &first.rotation.x,
+            &first.rotation.y, &first.rotation.z,
+            &first.rotation.w, &first.scale,
+            sizeof(LocalTransform) / sizeof(double)};
+}
+
+std::vector<TransformIsa> supportedIsas() {
+    std::vector<TransformIsa> isas;
+    for (const TransformIsa isa :
+         {TransformIsa::Scalar, TransformIsa::Avx2, TransformIsa::Avx512}) {
+        if (isa <= supportedTransformIsa()) {
+            isas.push_back(isa);
+        }
+    }
+    return isas;
+}
+
+void expectMatchesScalar(TransformIsa isa, const TrsStreams& in) {
+    std::vector<double> reference(kMaxCount * kMatrixStride);
+    std::vector<double> actual(kMaxCount * kMatrixStride);
+    for (std::size_t count = 1; count <= kMaxCount; count++) {
+        SCOPED_TRACE(testing::Message() << "isa " << static_cast<int>(isa)
+                                        << ", count " << count);
+        // a sentinel past the last matrix catches overlong writes
+        std::fill(actual.begin(), actual.end(), NAN);
+        composeTrs(TransformIsa::Scalar, in, reference.data(), kMatrixStride,
+                   count);
+        composeTrs(isa, in, actual.data(), kMatrixStride, count);
+
+        for (std::size_t i = 0; i < count * kMatrixStride; i++) {
+            if (isa == TransformIsa::Avx512) {
+                ASSERT_NEAR(actual[i], reference[i], kAvx512Tolerance)
+                        << "element " << i;
+            } else {
+                ASSERT_EQ(actual[i], reference[i]) << "element " << i;
+            }
+        }
+        for (std::size_t i = count * kMatrixStride; i < actual.size(); i++) {
+            ASSERT_TRUE(std::isnan(actual[i])) << "element " << i;
+        }
+    }
+}
+}  // namespace
+
+TEST(TransformKernelTest, StructureOfArraysMatchesScalar) {
+    std::mt19937_64 generator(5);
+    SoaTransforms soa;
+    std::vector<LocalTransform> locals;
+    randomTransforms(generator, soa, locals);
+
+    for (const TransformIsa isa : supportedIsas()) {
+        expectMatchesScalar(isa, soa.streams());
+    }
+}
+
+TEST(TransformKernelTest, LocalTransformColumnMatchesScalar) {
+    std::mt19937_64 generator(7);
+    SoaTransforms soa;
+    std::vector<LocalTransform> locals;
+    randomTransforms(generator, soa, locals);
+
+    for (const TransformIsa isa : supportedIsas()) {
+        expectMatchesScalar(isa, columnStreams(locals));
+    }
+}
+
+TEST(TransformKernelTest, LayoutsAgree) {
+    std::mt19937_64 generator(11);
+    SoaTransforms soa;
+    std::vector<LocalTransform> locals;
+    randomTransforms(generator, soa, locals);
+
+    // the gathers read the same values the contiguous loads do
+    for (const TransformIsa isa : supportedIsas()) {
+        SCOPED_TRACE(testing::Message() << "isa " << static_cast<int>(isa));
+        std::vector<double> fromSoa(kMaxCount * kMatrixStride);
+        std::vector<double> fromColumn(kMaxCount * kMatrixStride);
+        composeTrs(isa, soa.streams(), fromSoa.data(), kMatrixStride,
+                   kMaxCount);
+        composeTrs(isa, columnStreams(locals), fromColumn.data(),
+                   kMatrixStride, kMaxCount);
+        EXPECT_EQ(fromSoa, fromColumn);
+    }
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "core/JobSystem.h"
+#include "scene/ParentSystem.h"
+#include "scene/TransformSystem.h"
+
+// Scaling of the transform propagation pass over thread counts, for a
+// million entities split into trees with a fan-out of 10 and depth of 3.
+
+namespace {
+constexpr int kRoots = 900;
+constexpr int kFanOut = 10;
+constexpr int kDepth = 3;
+constexpr int kFrames = 5;
+
+flecs::entity createNode(flecs::world& world, flecs::entity parent,
+                         int index) {
+    const auto offset = static_cast<double>(index % kFanOut);
+    flecs::entity e = world.entity();
+    e.set(LocalTransform{
+            glm::f64vec3(offset, 1.0, -offset),
+            glm::angleAxis(0.1 * offset, glm::f64vec3(0.0, 1.0, 0.0)),
+            1.0 + 0.01 * offset});
+    e.set(GlobalTransform{glm::f64mat4(1.0)});
+    if (parent.is_valid()) {
+        setRelation(e, parent);
+    }
+    return e;
+}
+
+// returns the last leaf created
+flecs::entity createTree(flecs::world& world, flecs::entity node, int depth) {
+    if (depth == kDepth) {
+        return node;
+    }
+    flecs::entity leaf;
+    for (int i = 0; i < kFanOut; i++) {
+        leaf = createTree(world, createNode(world, node, i), depth + 1);
+    }
+    return leaf;
+}
+}  // namespace
+
+TEST(TransformPropagationBenchmark, Scaling1M) {
+    // no systems are registered, the pass is driven by hand
+    flecs::world world;
+
+    std::vector<flecs::entity> roots;
+    flecs::entity leaf;
+    for (int i = 0; i < kRoots; i++) {
+        roots.push_back(createNode(world, flecs::entity(), i));
+        leaf = createTree(world, roots.back(), 0);
+    }
+
+    uint32_t entityCount = 0;
+    for (int level = 0, width = kRoots; level <= kDepth;
+         level++, width *= kFanOut) {
+        entityCount += static_cast<uint32_t>(width);
+    }
+
+    const unsigned hardwareThreads =
+            std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> threadCounts;
+    for (unsigned threads = 1; threads < hardwareThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(hardwareThreads);
+
+    double singleThreadMs = 0.0;
+    glm::f64mat4 reference(0.0);
+    for (const unsigned threads : threadCounts) {
+        JobSystem jobs(threads);
+        TransformPropagationStats stats{};
+
+        const double ms = measureMs([&] {
+            for (int frame = 0; frame < kFrames; frame++) {
+                for (const flecs::entity root : roots) {
+                    markTransformDirty(root);
+                }
+                stats = propagateTransforms(world, &jobs);
+            }
+        }) / kFrames;
+        if (threads == 1) {
+            singleThreadMs = ms;
+            reference = leaf.get<GlobalTransform>()->TransformMatrix;
+        }
+
+        std::cout << entityCount << " entities, " << threads
+                  << " threads: " << ms << " ms (x" << singleThreadMs / ms
+                  << ")\n";
+
+        EXPECT_EQ(stats.dirtyRoots, static_cast<uint32_t>(kRoots));
+        EXPECT_EQ(stats.updatedEntities, entityCount);
+        EXPECT_EQ(stats.depth, static_cast<uint32_t>(kDepth + 1));
+        // every thread count writes exactly the same matrices
+        EXPECT_EQ(leaf.get<GlobalTransform>()->TransformMatrix, reference);
+    }
+}
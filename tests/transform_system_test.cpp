@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "scene/ParentSystem.h"
+#include "scene/TransformSystem.h"
+
+// Correctness of the transform propagation pass: composition against the
+// parent, depth order, exactly once writes and the lifetime of the lists in
+// TransformChanges.
+
+namespace {
+LocalTransform makeLocal(const glm::f64vec3& position, double angle,
+                         double scale) {
+    return {position, glm::angleAxis(angle, glm::f64vec3(0.0, 1.0, 0.0)),
+            scale};
+}
+
+void expectNear(const glm::f64mat4& actual, const glm::f64mat4& expected) {
+    for (int c = 0; c < 4; c++) {
+        for (int r = 0; r < 4; r++) {
+            EXPECT_NEAR(actual[c][r], expected[c][r], 1e-9);
+        }
+    }
+}
+
+void expectNear(const LocalTransform& actual, const LocalTransform& expected) {
+    expectNear(getMatrixFromLocal(actual), getMatrixFromLocal(expected));
+}
+
+// no systems are registered, so nothing but the pass touches the transforms
+flecs::entity createNode(flecs::world& world, flecs::entity parent,
+                         const LocalTransform& local) {
+    flecs::entity e = world.entity();
+    e.set(local);
+    e.set(GlobalTransform{glm::f64mat4(1.0)});
+    if (parent.is_valid()) {
+        setRelation(e, parent);
+    }
+    return e;
+}
+}  // namespace
+
+TEST(TransformSystemTest, LocalOnlyChildComposesWithParent) {
+    flecs::world world;
+    ParentSystem(world);
+    TransformSystem(world);
+
+    const LocalTransform parentLocal =
+            makeLocal(glm::f64vec3(1.0, 2.0, 3.0), 0.5, 2.0);
+    const LocalTransform childLocal =
+            makeLocal(glm::f64vec3(0.0, 0.0, -4.0), -1.2, 0.5);
+    flecs::entity parent = world.entity();
+    parent.set(parentLocal);
+    flecs::entity child = world.entity();
+    child.set(childLocal);
+    setRelation(child, parent);
+
+    // the second update catches locals rewritten when the pass's deferred
+    // changes are applied
+    for (int frame = 0; frame < 2; frame++) {
+        world.progress();
+
+        ASSERT_TRUE(parent.has<GlobalTransform>());
+        ASSERT_TRUE(child.has<GlobalTransform>());
+        expectNear(parent.get<GlobalTransform>()->TransformMatrix,
+                   getMatrixFromLocal(parentLocal));
+        expectNear(child.get<GlobalTransform>()->TransformMatrix,
+                   getMatrixFromLocal(parentLocal) *
+                           getMatrixFromLocal(childLocal));
+        expectNear(*child.get<LocalTransform>(), childLocal);
+    }
+}
+
+TEST(TransformSystemTest, WritesEachEntityOnceInDepthOrder) {
+    flecs::world world;
+    const LocalTransform local = makeLocal(glm::f64vec3(1.0, 0.0, 0.0), 0.3,
+                                           1.5);
+    flecs::entity root = createNode(world, flecs::entity(), local);
+    flecs::entity middle = createNode(world, root, local);
+    flecs::entity leaf = createNode(world, middle, local);
+    flecs::entity sibling = createNode(world, root, local);
+    flecs::entity unrelated = createNode(world, flecs::entity(), local);
+
+    // the leaf is reached from the root, not walked a second time
+    markTransformDirty(root);
+    markTransformDirty(leaf);
+    const TransformPropagationStats stats = propagateTransforms(world);
+
+    EXPECT_EQ(stats.dirtyRoots, 1u);
+    EXPECT_EQ(stats.updatedEntities, 4u);
+    EXPECT_EQ(stats.depth, 3u);
+
+    const glm::f64mat4 matrix = getMatrixFromLocal(local);
+    expectNear(root.get<GlobalTransform>()->TransformMatrix, matrix);
+    expectNear(middle.get<GlobalTransform>()->TransformMatrix,
+               matrix * matrix);
+    expectNear(leaf.get<GlobalTransform>()->TransformMatrix,
+               matrix * matrix * matrix);
+    expectNear(sibling.get<GlobalTransform>()->TransformMatrix,
+               matrix * matrix);
+    expectNear(unrelated.get<GlobalTransform>()->TransformMatrix,
+               glm::f64mat4(1.0));
+}
+
+TEST(TransformSystemTest, ChangesLastOnePass) {
+    flecs::world world;
+    const LocalTransform local = makeLocal(glm::f64vec3(0.0, 1.0, 0.0), 0.7,
+                                           1.0);
+    flecs::entity root = createNode(world, flecs::entity(), local);
+    flecs::entity child = createNode(world, root, local);
+    createNode(world, flecs::entity(), local);
+    const int32_t rootColumns = root.type().count();
+
+    // queued twice, written once
+    markTransformDirty(root);
+    markTransformDirty(root);
+    propagateTransforms(world);
+
+    const TransformChanges* changes = world.get<TransformChanges>();
+    EXPECT_TRUE(changes->dirty.empty());
+    const std::vector<flecs::entity_t> expected = {root.id(), child.id()};
+    EXPECT_EQ(changes->changed, expected);
+    // tracked outside the entity, which keeps its table
+    EXPECT_EQ(root.type().count(), rootColumns);
+
+    // consumers had their frame, nothing moved since
+    const TransformPropagationStats stats = propagateTransforms(world);
+    EXPECT_EQ(stats.updatedEntities, 0u);
+    EXPECT_TRUE(world.get<TransformChanges>()->changed.empty());
+}